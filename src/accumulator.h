@@ -0,0 +1,61 @@
+#ifndef WINDMOLEN_ACCUMULATOR_H_
+#define WINDMOLEN_ACCUMULATOR_H_
+
+
+#include <assert.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "board.h"
+#include "piece.h"
+#include "util.h"
+
+
+
+// The number of neurons in the first layer of the network, per perspective.
+static constexpr size_t NNUE_HIDDEN_SIZE = 256;
+
+// The maximum number of pieces that can change in a single move. This is the case for castling, where both the king and
+// the rook are removed and placed again.
+static constexpr size_t MAX_DIRTY_PIECES = 4;
+
+
+// This structure contains the pieces that were placed and removed by the move that led to a position. A removed piece
+// has no destination and a placed piece has no source. If more pieces changed than fit, e.g. when setting up a position,
+// `count` exceeds MAX_DIRTY_PIECES and the accumulator must be refreshed.
+struct DirtyPieces {
+    size_t count;
+    enum Piece pieces[MAX_DIRTY_PIECES];
+    enum Square sources[MAX_DIRTY_PIECES];
+    enum Square destinations[MAX_DIRTY_PIECES];
+};
+
+// The accumulator contains the first layer of the network for both perspectives. The values of a perspective are only
+// valid if `computed` is set for that perspective, in which case `king_squares` contains the king square they were
+// computed for.
+struct Accumulator {
+    alignas(64) int16_t values[COLOR_COUNT][NNUE_HIDDEN_SIZE];
+    enum Square king_squares[COLOR_COUNT];
+    bool computed[COLOR_COUNT];
+};
+
+
+// Records in `dirty_pieces` that `piece` moved from `source` to `destination`, where either can be SQUARE_NONE.
+static INLINE void add_dirty_piece(struct DirtyPieces* dirty_pieces, const enum Piece piece, const enum Square source,
+                                   const enum Square destination) {
+    assert(dirty_pieces != nullptr);
+    assert(is_valid_piece(piece));
+    assert(source != SQUARE_NONE || destination != SQUARE_NONE);
+
+    const size_t index = dirty_pieces->count++;
+    if (index >= MAX_DIRTY_PIECES)
+        return;
+
+    dirty_pieces->pieces[index]       = piece;
+    dirty_pieces->sources[index]      = source;
+    dirty_pieces->destinations[index] = destination;
+}
+
+
+
+#endif /* #ifndef WINDMOLEN_ACCUMULATOR_H_ */
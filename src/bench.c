@@ -0,0 +1,89 @@
+#include "bench.h"
+
+#include <assert.h>
+#include <inttypes.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+
+#include "engine.h"
+#include "options.h"
+#include "position.h"
+#include "thread.h"
+#include "time_manager.h"
+
+
+
+const char* const bench_positions[BENCH_POSITION_COUNT] = {
+    "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1",
+    "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1",
+    "8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 1",
+    "r3k2r/Pppp1ppp/1b3nbN/nP6/BBP1P3/q4N2/Pp1P2PP/R2Q1RK1 w kq - 0 1",
+    "rnbq1k1r/pp1Pbppp/2p5/8/2B5/8/PPP1NnPP/RNBQK2R w KQ - 1 8",
+    "r4rk1/1pp1qppp/p1np1n2/2b1p1B1/2B1P1b1/P1NP1N2/1PP1QPPP/R4RK1 w - - 0 10",
+    "r1bq1rk1/pp2ppbp/2np1np1/8/3NP3/2N1BP2/PPPQ2PP/R3KB1R w KQ - 3 9",
+    "r1bqkb1r/pp3ppp/2n1pn2/2pp4/3P4/2PBPN2/PP3PPP/RNBQK2R w KQkq - 0 6",
+    "2r3k1/pp3ppp/4p3/3pP3/1P1n4/P2B4/5PPP/2R3K1 b - - 0 24",
+    "r1b2rk1/2q1bppp/p2ppn2/1p6/3BPP2/2NB4/PPPQ2PP/2KR3R w - - 2 14",
+    "6k1/5p2/6p1/8/7p/8/6PP/6K1 b - - 0 1",
+    "8/8/1p6/p1p5/P1P2k2/1P6/4K3/8 w - - 0 1",
+    "8/3k4/8/4P3/4K3/8/8/8 w - - 0 1",
+    "8/8/4kpp1/3p1b2/p6P/2B5/6P1/6K1 b - - 0 47",
+    "4k3/8/8/8/8/8/8/4K2R w K - 0 1",
+    "6k1/6p1/6Pp/ppp5/3pn2P/1P3K2/1PP2P2/8 b - - 0 1",
+};
+
+
+void bench(struct Engine* engine, const size_t depth, const size_t thread_count, const uint64_t hash_size) {
+    assert(engine != nullptr);
+    assert(depth > 0 && depth <= MAX_SEARCH_DEPTH);
+    assert(thread_count >= OPTION_THREAD_COUNT_MIN && thread_count <= OPTION_THREAD_COUNT_MAX);
+
+    wait_until_finished_searching(&engine->thread_pool, true);
+
+    // Only the options that change the number of nodes searched are set, the others are kept. Splitting the root moves
+    // and probing the tablebases would make the signature depend on the options and the tablebases that are installed.
+    const struct Options options       = engine->options;
+    engine->options.thread_count       = thread_count;
+    engine->options.hash_size          = hash_size;
+    engine->options.multi_pv           = OPTION_MULTI_PV_DEFAULT;
+    engine->options.split_root_moves   = false;
+    engine->options.syzygy_probe_limit = 0;
+    resize_thread_pool(&engine->thread_pool, thread_count);
+
+    uint64_t total_nodes = 0;
+    uint64_t total_time  = 0;
+
+    for (size_t i = 0; i < BENCH_POSITION_COUNT; ++i) {
+        printf("\nPosition %zu/%zu: %s\n", i + 1, BENCH_POSITION_COUNT, bench_positions[i]);
+
+        engine->info_history_count = 0;
+        setup_position_from_fen(&engine->position, &engine->info_history[engine->info_history_count++],
+                                bench_positions[i]);
+
+        reset_time_manager(&engine->time_manager);
+        reset_search_arguments(&engine->search_arguments);
+        engine->search_arguments.infinite_search  = false;
+        engine->search_arguments.max_search_depth = depth;
+
+        const uint64_t start_time = get_time_us();
+        start_search(engine);
+        wait_until_finished_searching(&engine->thread_pool, true);
+        total_time += get_time_us() - start_time;
+
+        total_nodes += total_nodes_searched(&engine->thread_pool);
+    }
+
+    engine->options = options;
+    resize_thread_pool(&engine->thread_pool, options.thread_count);
+
+    engine->info_history_count = 0;
+    setup_start_position(&engine->position, &engine->info_history[engine->info_history_count++]);
+
+    const uint64_t nps = (total_time == 0) ? 0 : 1000000 * total_nodes / total_time;
+
+    printf("\n===========================\n");
+    printf("Total time (ms) : %" PRIu64 "\n", total_time / 1000);
+    printf("Nodes searched  : %" PRIu64 "\n", total_nodes);
+    printf("Nodes/second    : %" PRIu64 "\n", nps);
+}
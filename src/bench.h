@@ -0,0 +1,29 @@
+#ifndef WINDMOLEN_BENCH_H_
+#define WINDMOLEN_BENCH_H_
+
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "engine.h"
+
+
+
+static constexpr size_t BENCH_DEFAULT_DEPTH = 6;
+
+static constexpr size_t BENCH_POSITION_COUNT = 16;
+
+// A mix of openings, middle games with tactics, promotions and endgames, such that most parts of the search and the
+// evaluation are exercised. These positions are also the corpus of the microbenchmarks.
+extern const char* const bench_positions[BENCH_POSITION_COUNT];
+
+
+// Searches a fixed set of positions to `depth` with `thread_count` threads, and prints the total number of nodes, the
+// time spent and the nodes per second. The hash size of `hash_size` MB is a no-op until the search has a transposition
+// table. With a single thread, the number of nodes is a signature of the search: it only changes if the search or the
+// evaluation changes. The options of `engine` are restored afterwards and its position is set to the start position.
+void bench(struct Engine* engine, size_t depth, size_t thread_count, uint64_t hash_size);
+
+
+
+#endif /* #ifndef WINDMOLEN_BENCH_H_ */
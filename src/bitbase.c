@@ -0,0 +1,219 @@
+#include "bitbase.h"
+
+#include <assert.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "bitboard.h"
+#include "board.h"
+#include "piece.h"
+#include "util.h"
+
+
+
+// The bitbase only contains positions with the pawn on files A to D, as the other positions are mirror images. The
+// pawn can be on ranks 2 to 7, which leaves 24 pawn squares.
+static constexpr size_t KPK_PAWN_FILE_COUNT   = 4;
+static constexpr size_t KPK_PAWN_SQUARE_COUNT = KPK_PAWN_FILE_COUNT * 6;
+static constexpr size_t KPK_INDEX_COUNT       = COLOR_COUNT * SQUARE_COUNT * SQUARE_COUNT * KPK_PAWN_SQUARE_COUNT;
+
+// Every position is stored in 2 bits.
+enum KpkResult : uint8_t {
+    KPK_INVALID = 0,
+    KPK_UNKNOWN = 1,
+    KPK_DRAW    = 2,
+    KPK_WIN     = 3,
+};
+
+static uint8_t kpk_bitbase[KPK_INDEX_COUNT / 4];
+
+// During the retrograde analysis, every position has its own byte, which is faster to access.
+static uint8_t* kpk_results;
+
+
+// Returns the index of the position with the white king on `white_king`, the black king on `black_king`, the white pawn
+// on `pawn` and `side_to_move` to move.
+static INLINE size_t kpk_index(const enum Color side_to_move, const enum Square white_king,
+                               const enum Square black_king, const enum Square pawn) {
+    assert(file_of_square(pawn) <= FILE_D);
+    assert(rank_of_square(pawn) >= RANK_2 && rank_of_square(pawn) <= RANK_7);
+
+    const size_t pawn_index = (size_t)(rank_of_square(pawn) - RANK_2) * KPK_PAWN_FILE_COUNT + file_of_square(pawn);
+
+    return side_to_move + COLOR_COUNT * (black_king + SQUARE_COUNT * (white_king + SQUARE_COUNT * pawn_index));
+}
+
+// Returns the result of the position with `index` during the retrograde analysis.
+static INLINE enum KpkResult get_result(const size_t index) {
+    assert(index < KPK_INDEX_COUNT);
+
+    return (enum KpkResult)kpk_results[index];
+}
+
+
+// Returns the result of the position that follows from the rules alone: positions that cannot occur, promotions that
+// cannot be prevented, a captured pawn and mate or stalemate. All other positions are unknown.
+static enum KpkResult initial_result(const enum Color side_to_move, const enum Square white_king,
+                                     const enum Square black_king, const enum Square pawn) {
+    const Bitboard white_king_attacks = piece_base_attacks(PIECE_TYPE_KING, white_king);
+    const Bitboard black_king_attacks = piece_base_attacks(PIECE_TYPE_KING, black_king);
+    const Bitboard pawn_attacks       = piece_base_attacks(PIECE_TYPE_WHITE_PAWN, pawn);
+
+    if (distance(white_king, black_king) <= 1 || white_king == pawn || black_king == pawn
+        || (side_to_move == COLOR_WHITE && (pawn_attacks & square_bitboard(black_king)) != EMPTY_BITBOARD))
+        return KPK_INVALID;
+
+    if (side_to_move == COLOR_WHITE) {
+        // The pawn promotes safely if the black king cannot reach the promotion square, or if it is defended.
+        const enum Square promotion_square = square_north(pawn);
+        if (rank_of_square(pawn) == RANK_7 && white_king != promotion_square
+            && (distance(black_king, promotion_square) > 1 || distance(white_king, promotion_square) == 1))
+            return KPK_WIN;
+    } else {
+        const Bitboard black_king_moves = black_king_attacks & ~(white_king_attacks | pawn_attacks);
+
+        if (black_king_moves == EMPTY_BITBOARD)
+            return ((pawn_attacks & square_bitboard(black_king)) != EMPTY_BITBOARD) ? KPK_WIN : KPK_DRAW;
+
+        // The black king can capture an undefended pawn.
+        if ((black_king_moves & square_bitboard(pawn) & ~white_king_attacks) != EMPTY_BITBOARD)
+            return KPK_DRAW;
+    }
+
+    return KPK_UNKNOWN;
+}
+
+// Returns the result of the unknown position from the results of the positions after every move. White wins if any move
+// wins, black draws if any move draws. The result remains unknown if the best move is not known yet.
+static enum KpkResult classify(const enum Color side_to_move, const enum Square white_king,
+                               const enum Square black_king, const enum Square pawn) {
+    const enum Color opponent = opposite_color(side_to_move);
+    const enum KpkResult good = (side_to_move == COLOR_WHITE) ? KPK_WIN : KPK_DRAW;
+    const enum KpkResult bad  = (side_to_move == COLOR_WHITE) ? KPK_DRAW : KPK_WIN;
+
+    bool unknown = false;
+
+    // Moves into invalid positions are illegal.
+    Bitboard king_moves = piece_base_attacks(PIECE_TYPE_KING, (side_to_move == COLOR_WHITE) ? white_king : black_king);
+    while (king_moves != EMPTY_BITBOARD) {
+        const enum Square destination = (enum Square)pop_lsb64(&king_moves);
+
+        const enum KpkResult result = (side_to_move == COLOR_WHITE)
+                                        ? get_result(kpk_index(opponent, destination, black_king, pawn))
+                                        : get_result(kpk_index(opponent, white_king, destination, pawn));
+
+        if (result == good)
+            return good;
+        unknown |= result == KPK_UNKNOWN;
+    }
+
+    // Promotions have been resolved by the initial results, so only pushes to the seventh rank are considered.
+    if (side_to_move == COLOR_WHITE && rank_of_square(pawn) < RANK_7) {
+        const enum Square push = square_north(pawn);
+
+        if (push != white_king && push != black_king) {
+            const enum KpkResult result = get_result(kpk_index(opponent, white_king, black_king, push));
+            if (result == good)
+                return good;
+            unknown |= result == KPK_UNKNOWN;
+
+            const enum Square double_push = square_north(push);
+            if (rank_of_square(pawn) == RANK_2 && double_push != white_king && double_push != black_king) {
+                const enum KpkResult double_result = get_result(
+                kpk_index(opponent, white_king, black_king, double_push));
+                if (double_result == good)
+                    return good;
+                unknown |= double_result == KPK_UNKNOWN;
+            }
+        }
+    }
+
+    return unknown ? KPK_UNKNOWN : bad;
+}
+
+
+void initialize_kpk_bitbase() {
+    kpk_results = malloc(KPK_INDEX_COUNT);
+
+    for (enum Square pawn = SQUARE_A2; pawn <= SQUARE_H7; ++pawn) {
+        if (file_of_square(pawn) > FILE_D)
+            continue;
+
+        for (enum Square white_king = SQUARE_A1; white_king < SQUARE_COUNT; ++white_king) {
+            for (enum Square black_king = SQUARE_A1; black_king < SQUARE_COUNT; ++black_king) {
+                for (enum Color side_to_move = COLOR_WHITE; side_to_move < COLOR_COUNT; ++side_to_move) {
+                    kpk_results[kpk_index(side_to_move, white_king, black_king, pawn)] = initial_result(
+                    side_to_move, white_king, black_king, pawn);
+                }
+            }
+        }
+    }
+
+    // Pawn moves are irreversible, so the positions of a pawn square only depend on each other and on positions with the
+    // pawn further up the board. We therefore solve the pawn squares one by one, from the seventh rank down. For every
+    // pawn square, we keep classifying unknown positions until nothing changes. The positions that are still unknown
+    // then are draws, as white cannot force a win from them.
+    for (enum Square pawn = SQUARE_H7; pawn >= SQUARE_A2; --pawn) {
+        if (file_of_square(pawn) > FILE_D)
+            continue;
+
+        bool changed = true;
+        while (changed) {
+            changed = false;
+
+            for (enum Square white_king = SQUARE_A1; white_king < SQUARE_COUNT; ++white_king) {
+                for (enum Square black_king = SQUARE_A1; black_king < SQUARE_COUNT; ++black_king) {
+                    for (enum Color side_to_move = COLOR_WHITE; side_to_move < COLOR_COUNT; ++side_to_move) {
+                        const size_t index = kpk_index(side_to_move, white_king, black_king, pawn);
+                        if (get_result(index) != KPK_UNKNOWN)
+                            continue;
+
+                        const enum KpkResult result = classify(side_to_move, white_king, black_king, pawn);
+                        if (result != KPK_UNKNOWN) {
+                            kpk_results[index] = result;
+                            changed            = true;
+                        }
+                    }
+                }
+            }
+        }
+
+        for (enum Square white_king = SQUARE_A1; white_king < SQUARE_COUNT; ++white_king) {
+            for (enum Square black_king = SQUARE_A1; black_king < SQUARE_COUNT; ++black_king) {
+                for (enum Color side_to_move = COLOR_WHITE; side_to_move < COLOR_COUNT; ++side_to_move) {
+                    const size_t index = kpk_index(side_to_move, white_king, black_king, pawn);
+                    if (get_result(index) == KPK_UNKNOWN)
+                        kpk_results[index] = KPK_DRAW;
+                }
+            }
+        }
+    }
+
+    // Pack the results into 2 bits per position.
+    memset(kpk_bitbase, 0, sizeof(kpk_bitbase));
+    for (size_t index = 0; index < KPK_INDEX_COUNT; ++index)
+        kpk_bitbase[index / 4] |= (uint8_t)(kpk_results[index] << (2 * (index % 4)));
+
+    free(kpk_results);
+    kpk_results = nullptr;
+}
+
+bool probe_kpk_bitbase(enum Square white_king, enum Square white_pawn, enum Square black_king,
+                       const enum Color side_to_move) {
+    assert(is_valid_square(white_king));
+    assert(is_valid_square(white_pawn));
+    assert(is_valid_square(black_king));
+    assert(is_valid_color(side_to_move));
+
+    // Mirror the position such that the pawn is on files A to D.
+    if (file_of_square(white_pawn) > FILE_D) {
+        white_king = (enum Square)(white_king ^ 7);
+        white_pawn = (enum Square)(white_pawn ^ 7);
+        black_king = (enum Square)(black_king ^ 7);
+    }
+
+    const size_t index = kpk_index(side_to_move, white_king, black_king, white_pawn);
+    return ((kpk_bitbase[index / 4] >> (2 * (index % 4))) & 3) == KPK_WIN;
+}
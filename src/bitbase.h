@@ -0,0 +1,21 @@
+#ifndef WINDMOLEN_BITBASE_H_
+#define WINDMOLEN_BITBASE_H_
+
+
+#include "board.h"
+#include "piece.h"
+
+
+
+// Builds the KPK bitbase by retrograde analysis. This must be called once at startup, after the bitboards have been
+// initialized.
+void initialize_kpk_bitbase();
+
+// Returns whether the position with the white king on `white_king`, a white pawn on `white_pawn`, the black king on
+// `black_king` and `side_to_move` to move is won for white. The position must be legal.
+bool probe_kpk_bitbase(enum Square white_king, enum Square white_pawn, enum Square black_king,
+                       enum Color side_to_move);
+
+
+
+#endif /* #ifndef WINDMOLEN_BITBASE_H_ */
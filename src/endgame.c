@@ -0,0 +1,102 @@
+#include "endgame.h"
+
+#include <assert.h>
+
+#include "bitbase.h"
+#include "bitboard.h"
+#include "board.h"
+#include "piece.h"
+#include "position.h"
+#include "score.h"
+#include "util.h"
+
+
+
+// Rough material values, only used to prefer keeping more material while mating.
+static const Value endgame_piece_values[PIECE_TYPE_COUNT] = {
+    [PIECE_TYPE_PAWN] = 100, [PIECE_TYPE_KNIGHT] = 300, [PIECE_TYPE_BISHOP] = 300,
+    [PIECE_TYPE_ROOK] = 500, [PIECE_TYPE_QUEEN] = 900,
+};
+
+
+// Returns the distance of `square` to the closest edge of the board.
+static INLINE int edge_distance(const enum Square square) {
+    assert(is_valid_square(square));
+
+    const int file = file_of_square(square);
+    const int rank = rank_of_square(square);
+
+    const int file_distance = (file < FILE_COUNT - 1 - file) ? file : FILE_COUNT - 1 - file;
+    const int rank_distance = (rank < RANK_COUNT - 1 - rank) ? rank : RANK_COUNT - 1 - rank;
+
+    return (file_distance < rank_distance) ? file_distance : rank_distance;
+}
+
+// Returns the sum of the values of the non-king pieces of `color` in `position`.
+static Value material_value(const struct Position* position, const enum Color color) {
+    assert(position != nullptr);
+    assert(is_valid_color(color));
+
+    Value value = 0;
+    for (enum PieceType piece_type = PIECE_TYPE_PAWN; piece_type < PIECE_TYPE_KING; ++piece_type)
+        value += endgame_piece_values[piece_type] * popcount64(piece_occupancy(position, color, piece_type));
+
+    return value;
+}
+
+
+Value evaluate_kxk(const struct Position* position, const enum Color strong_side) {
+    assert(position != nullptr);
+    assert(is_valid_color(strong_side));
+
+    const enum Square strong_king = king_square(position, strong_side);
+    const enum Square weak_king   = king_square(position, opposite_color(strong_side));
+
+    // The weak king should be pushed to the edge, where the strong king must be close to it to deliver mate.
+    return KNOWN_WIN_VALUE + material_value(position, strong_side) + 20 * (3 - edge_distance(weak_king))
+         + 10 * (7 - distance(strong_king, weak_king));
+}
+
+Value evaluate_kbnk(const struct Position* position, const enum Color strong_side) {
+    assert(position != nullptr);
+    assert(is_valid_color(strong_side));
+
+    const enum Square strong_king = king_square(position, strong_side);
+    const enum Square weak_king   = king_square(position, opposite_color(strong_side));
+    const enum Square bishop      = (enum Square)lsb64(piece_occupancy(position, strong_side, PIECE_TYPE_BISHOP));
+
+    // Mate can only be forced in a corner of the color of the bishop. A1 and H8 are dark squares.
+    const bool dark_bishop = ((file_of_square(bishop) + rank_of_square(bishop)) & 1) == 0;
+    const int corner_distance = dark_bishop ? ((distance(weak_king, SQUARE_A1) < distance(weak_king, SQUARE_H8))
+                                                   ? distance(weak_king, SQUARE_A1)
+                                                   : distance(weak_king, SQUARE_H8))
+                                            : ((distance(weak_king, SQUARE_A8) < distance(weak_king, SQUARE_H1))
+                                                   ? distance(weak_king, SQUARE_A8)
+                                                   : distance(weak_king, SQUARE_H1));
+
+    return KNOWN_WIN_VALUE + material_value(position, strong_side) + 20 * (7 - corner_distance)
+         + 10 * (7 - distance(strong_king, weak_king));
+}
+
+Value evaluate_kpk(const struct Position* position, const enum Color strong_side) {
+    assert(position != nullptr);
+    assert(is_valid_color(strong_side));
+
+    enum Square strong_king = king_square(position, strong_side);
+    enum Square weak_king   = king_square(position, opposite_color(strong_side));
+    enum Square pawn        = (enum Square)lsb64(piece_occupancy(position, strong_side, PIECE_TYPE_PAWN));
+    enum Color side_to_move = position->side_to_move;
+
+    // The bitbase assumes white is the strong side, so we flip the board if it is black.
+    if (strong_side == COLOR_BLACK) {
+        strong_king  = (enum Square)(strong_king ^ 56);
+        weak_king    = (enum Square)(weak_king ^ 56);
+        pawn         = (enum Square)(pawn ^ 56);
+        side_to_move = opposite_color(side_to_move);
+    }
+
+    if (!probe_kpk_bitbase(strong_king, pawn, weak_king, side_to_move))
+        return DRAW_VALUE;
+
+    return KNOWN_WIN_VALUE + endgame_piece_values[PIECE_TYPE_PAWN] + 10 * rank_of_square(pawn);
+}
@@ -0,0 +1,31 @@
+#ifndef WINDMOLEN_ENDGAME_H_
+#define WINDMOLEN_ENDGAME_H_
+
+
+#include "piece.h"
+#include "position.h"
+#include "score.h"
+
+
+
+// The value of a position that is known to be won, but for which no mate has been found yet. The specialized endgame
+// functions add a bonus to this value that guides the search towards the mate.
+static constexpr Value KNOWN_WIN_VALUE = 10000;
+
+// A specialized endgame function returns the value of `position` from the perspective of `strong_side`, the side with
+// the winning chances.
+typedef Value (*EndgameFunction)(const struct Position* position, enum Color strong_side);
+
+
+// King and mating material versus a lone king, e.g. KRK and KQK. The weak king is driven to the edge of the board.
+Value evaluate_kxk(const struct Position* position, enum Color strong_side);
+
+// King, bishop and knight versus a lone king. The weak king is driven to a corner of the color of the bishop.
+Value evaluate_kbnk(const struct Position* position, enum Color strong_side);
+
+// King and pawn versus a lone king, which is looked up in the KPK bitbase.
+Value evaluate_kpk(const struct Position* position, enum Color strong_side);
+
+
+
+#endif /* #ifndef WINDMOLEN_ENDGAME_H_ */
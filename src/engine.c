@@ -6,9 +6,12 @@
 
 #include "constants.h"
 #include "options.h"
+#include "perft.h"
 #include "position.h"
+#include "syzygy.h"
 #include "thread.h"
 #include "time_manager.h"
+#include "trace.h"
 
 
 
@@ -38,10 +41,19 @@ void initialize_engine(struct Engine* engine) {
 
     initialize_options(&engine->options);
     reset_time_manager(&engine->time_manager);
+    engine->time_manager.move_overhead = 1000ULL * engine->options.move_overhead;
+    engine->time_manager.nodes_time    = engine->options.nodes_time;
     reset_search_arguments(&engine->search_arguments);
 
     engine->thread_pool.time_manager     = &engine->time_manager;
     engine->thread_pool.search_arguments = &engine->search_arguments;
+    engine->thread_pool.options          = &engine->options;
+    engine->thread_pool.profiles         = nullptr;
+
+    // No search is running yet.
+    atomic_store(&engine->thread_pool.stop_search, true);
+    atomic_store(&engine->thread_pool.stop_received, false);
+    atomic_store(&engine->thread_pool.pondering, false);
 
     // We need to make sure the thread pool starts with 0 threads to properly resize the thread pool.
     engine->thread_pool.thread_count = 0;
@@ -63,13 +75,32 @@ void start_search(struct Engine* engine) {
 void stop_search(struct Engine* engine) {
     assert(engine != nullptr);
 
+    atomic_store(&engine->thread_pool.stop_received, true);
     atomic_store(&engine->thread_pool.stop_search, true);
 }
 
+void ponder_hit(struct Engine* engine) {
+    assert(engine != nullptr);
+
+    struct ThreadPool* thread_pool = &engine->thread_pool;
+    if (!atomic_load(&thread_pool->pondering))
+        return;
+
+    // The search continues as it is, so the time manager must be updated before the search threads see that they are
+    // no longer pondering.
+    if (!engine->search_arguments.infinite_search)
+        update_time_manager(&engine->time_manager, engine->position.side_to_move);
+    atomic_store(&thread_pool->pondering, false);
+    update_node_limit(thread_pool);
+}
+
 void quit_engine(struct Engine* engine) {
     assert(engine != nullptr);
 
     stop_search(engine);
 
     destroy_thread_pool(&engine->thread_pool);
+    free_tablebases();
+    free_perft_table();
+    close_search_trace();
 }
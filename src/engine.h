@@ -58,6 +58,8 @@ void initialize_engine(struct Engine* engine);
 void start_search(struct Engine* engine);
 // Stop the search of `engine`.
 void stop_search(struct Engine* engine);
+// Turn the ponder search of `engine` into a regular search, as the opponent played the expected move.
+void ponder_hit(struct Engine* engine);
 
 // Quit `engine`.
 void quit_engine(struct Engine* engine);
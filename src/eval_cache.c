@@ -0,0 +1,16 @@
+#include "eval_cache.h"
+
+#include <assert.h>
+#include <string.h>
+
+
+
+void clear_eval_cache(struct EvalCache* eval_cache) {
+    assert(eval_cache != nullptr);
+
+    // An empty entry could match a key whose upper bits are all zero, but such a collision is as unlikely as any other.
+    memset(eval_cache->entries, 0, sizeof(eval_cache->entries));
+
+    eval_cache->probes = 0;
+    eval_cache->hits   = 0;
+}
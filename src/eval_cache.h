@@ -0,0 +1,67 @@
+#ifndef WINDMOLEN_EVAL_CACHE_H_
+#define WINDMOLEN_EVAL_CACHE_H_
+
+
+#include <assert.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "score.h"
+#include "util.h"
+#include "zobrist.h"
+
+
+
+// The number of entries in an eval cache, which must be a power of two. With 8 byte entries, the cache takes 256 kB,
+// such that it fits in the L2 cache together with the other thread local tables.
+static constexpr size_t EVAL_CACHE_SIZE = 1 << 15;
+static_assert((EVAL_CACHE_SIZE & (EVAL_CACHE_SIZE - 1)) == 0);
+static_assert(EVAL_CACHE_SIZE <= 1 << 16);  // The index bits must not overlap with the stored key bits.
+
+// An entry packs the upper 48 bits of the Zobrist key together with the 16 bit score.
+static constexpr uint64_t EVAL_CACHE_KEY_MASK = ~(uint64_t)UINT16_MAX;
+
+// The eval cache is a thread local, direct mapped cache of static evaluations, indexed by the Zobrist key of a
+// position. It also counts how often it is probed and hit, to measure whether it pays off.
+struct EvalCache {
+    uint64_t entries[EVAL_CACHE_SIZE];
+
+    uint64_t probes;
+    uint64_t hits;
+
+    // The generation of the network whose evaluations are cached, see current_network_generation(), or 0 if none.
+    uint64_t network_generation;
+};
+
+
+// Removes all entries from `eval_cache` and resets its statistics.
+void clear_eval_cache(struct EvalCache* eval_cache);
+
+// Looks up the static evaluation of the position with `key` in `eval_cache`. Returns `true` and stores the evaluation
+// in `value` on a hit.
+static INLINE bool probe_eval_cache(struct EvalCache* eval_cache, const ZobristKey key, Value* value) {
+    assert(eval_cache != nullptr);
+    assert(value != nullptr);
+
+    ++eval_cache->probes;
+
+    const uint64_t entry = eval_cache->entries[key & (EVAL_CACHE_SIZE - 1)];
+    if ((entry & EVAL_CACHE_KEY_MASK) != (key & EVAL_CACHE_KEY_MASK))
+        return false;
+
+    ++eval_cache->hits;
+    *value = (Score)(uint16_t)entry;
+    return true;
+}
+
+// Stores the static evaluation `value` of the position with `key` in `eval_cache`, replacing any previous entry.
+static INLINE void store_eval_cache(struct EvalCache* eval_cache, const ZobristKey key, const Value value) {
+    assert(eval_cache != nullptr);
+    assert(is_valid_value(value));
+
+    eval_cache->entries[key & (EVAL_CACHE_SIZE - 1)] = (key & EVAL_CACHE_KEY_MASK) | (uint16_t)(Score)value;
+}
+
+
+
+#endif /* #ifndef WINDMOLEN_EVAL_CACHE_H_ */
@@ -2,27 +2,32 @@
 
 #include <assert.h>
 
-#include "piece.h"
+#include "material.h"
+#include "nnue.h"
+#include "pawns.h"
 #include "position.h"
 #include "score.h"
 
 
 
-Value evaluate_position(const struct Position* position) {
+Value evaluate_position(struct Evaluator* evaluator, struct PawnTable* pawn_table, struct MaterialTable* material_table,
+                        const struct Position* position) {
+    assert(evaluator != nullptr);
+    assert(pawn_table != nullptr);
+    assert(material_table != nullptr);
     assert(position != nullptr);
 
-    const struct PositionInfo* position_info = position->info;
+    const struct MaterialEntry* material = probe_material_table(material_table, position);
 
-    const Value middle_game_score = position_info->middle_game_score[COLOR_WHITE]
-                                  - position_info->middle_game_score[COLOR_BLACK];
-    const Value end_game_score = position_info->end_game_score[COLOR_WHITE]
-                               - position_info->end_game_score[COLOR_BLACK];
+    if (material->endgame != nullptr) {
+        const Value value = material->endgame(position, material->strong_side);
+        return (position->side_to_move == material->strong_side) ? value : -value;
+    }
 
-    /* Tapered eval. */
-    int middle_game_phase = position_info->game_phase;
-    if (middle_game_phase > 24)
-        middle_game_phase = 24;  // In case of an early promotion.
-    const int end_game_phase = 24 - middle_game_phase;
+    const Value value = evaluate_network(evaluator, position)
+                      + taper_score(evaluate_pawns(pawn_table, position), material->game_phase);
 
-    return (middle_game_score * middle_game_phase + end_game_score * end_game_phase) / 24;
+    // The value is scaled down if the side that is better has few winning chances.
+    const enum Color better_side = (value > 0) ? position->side_to_move : opposite_color(position->side_to_move);
+    return value * material->scale_factors[better_side] / SCALE_FACTOR_NORMAL;
 }
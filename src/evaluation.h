@@ -4,13 +4,19 @@
 
 #include <limits.h>
 
+#include "material.h"
+#include "nnue.h"
+#include "pawns.h"
 #include "position.h"
 #include "score.h"
 
 
 
-// Returns the value of `position`.
-Value evaluate_position(const struct Position* position);
+// Returns the value of `position` from the perspective of the side to move, using the network of `evaluator` and the
+// pawn structure terms cached in `pawn_table`. Material configurations in `material_table` with a specialized endgame
+// function are evaluated by that function instead.
+Value evaluate_position(struct Evaluator* evaluator, struct PawnTable* pawn_table, struct MaterialTable* material_table,
+                        const struct Position* position);
 
 
 
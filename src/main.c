@@ -1,7 +1,10 @@
 #include <stdio.h>
 
+#include "bitbase.h"
 #include "bitboard.h"
 #include "engine.h"
+#include "nnue.h"
+#include "nnue_kernels.h"
 #include "uci.h"
 #include "zobrist.h"
 
@@ -9,7 +12,10 @@
 
 int main(void) {
     initialize_bitboards();
+    initialize_kpk_bitbase();
     initialize_zobrist_keys();
+    initialize_default_network();
+    select_nnue_kernels();
 
     // Make sure stdout is line buffered.
     setvbuf(stdout, nullptr, _IOLBF, 0);
@@ -0,0 +1,243 @@
+#include "mate_search.h"
+
+#include <assert.h>
+#include <stdatomic.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "constants.h"
+#include "engine.h"
+#include "move.h"
+#include "move_generation.h"
+#include "position.h"
+#include "score.h"
+#include "thread.h"
+#include "time_manager.h"
+#include "uci.h"
+#include "util.h"
+
+
+
+// Returns whether `move` checks the enemy king in `position`.
+static INLINE bool gives_check(const struct Position* position, const Move move) {
+    assert(position != nullptr);
+    assert(!is_weird_move(move));
+
+    return gives_direct_check(position, move) || gives_discovered_check(position, move);
+}
+
+// Returns whether the mate search of `searcher` must be stopped, in which case nothing more can be proven. Reading the
+// clock is expensive compared to a node of the mate search, so the time is only checked every few nodes.
+static INLINE bool mate_search_stopped(struct Searcher* searcher) {
+    assert(searcher != nullptr);
+
+    constexpr uint64_t TIME_CHECK_INTERVAL = 1024;
+
+    struct ThreadPool* thread_pool = searcher->thread_pool;
+    if (is_main_thread(searcher) && (atomic_load(&searcher->nodes_searched) & (TIME_CHECK_INTERVAL - 1)) == 0
+        && !atomic_load(&thread_pool->pondering) && get_time_us() >= thread_pool->time_manager->cutoff_time)
+        atomic_store(&thread_pool->stop_search, true);
+
+    return atomic_load(&thread_pool->stop_search);
+}
+
+// Stores `move` followed by the principal variation of `ply + 1` as the principal variation of `ply` in `searcher`.
+static INLINE void update_principal_variation(struct Searcher* searcher, const size_t ply, const Move move) {
+    assert(searcher != nullptr);
+    assert(ply + 1 < MAX_SEARCH_DEPTH);
+
+    searcher->principal_variation_table[ply][0] = move;
+    memcpy(&searcher->principal_variation_table[ply][1], &searcher->principal_variation_table[ply + 1][0],
+           searcher->principal_variation_length[ply + 1] * sizeof(Move));
+    searcher->principal_variation_length[ply] = searcher->principal_variation_length[ply + 1] + 1;
+}
+
+static bool attacker_mates(struct Searcher* searcher, struct Position* position, const size_t moves_left,
+                           const size_t ply);
+
+// Returns whether the attacker, who just moved in `position`, mates within `moves_left` moves including the move just
+// played, no matter how the side to move defends.
+static bool defender_is_mated(struct Searcher* searcher, struct Position* position, const size_t moves_left,
+                              const size_t ply) {
+    assert(searcher != nullptr);
+    assert(position != nullptr);
+    assert(moves_left > 0);
+
+    if (!count_node(searcher))
+        return false;
+
+    searcher->principal_variation_length[ply] = 0;
+
+    Move move_list[MAX_MOVES];
+    const size_t move_count = generate_legal_moves(position, move_list);
+
+    // Without moves, it is either mate or stalemate.
+    if (move_count == 0)
+        return in_check(position);
+
+    if (moves_left == 1 || is_draw(position, ply))
+        return false;
+
+    struct PositionInfo info;
+    for (size_t i = 0; i < move_count; ++i) {
+        do_move(position, &info, move_list[i]);
+
+        const bool mated = attacker_mates(searcher, position, moves_left - 1, ply + 1);
+
+        undo_move(position, move_list[i]);
+
+        // A single defence that escapes mate refutes the attacking move.
+        if (!mated)
+            return false;
+
+        // Every defence so far leads to mate. The principal variation follows the defence that delays mate the longest.
+        if (searcher->principal_variation_length[ply + 1] + 1 > searcher->principal_variation_length[ply])
+            update_principal_variation(searcher, ply, move_list[i]);
+    }
+
+    return true;
+}
+
+// Returns whether the side to move in `position` can force mate within `moves_left` moves.
+static bool attacker_mates(struct Searcher* searcher, struct Position* position, const size_t moves_left,
+                           const size_t ply) {
+    assert(searcher != nullptr);
+    assert(position != nullptr);
+    assert(moves_left > 0);
+
+    if (!count_node(searcher))
+        return false;
+
+    searcher->principal_variation_length[ply] = 0;
+
+    if (mate_search_stopped(searcher))
+        return false;
+
+    if (is_draw(position, ply))
+        return false;
+
+    Move move_list[MAX_MOVES];
+    const size_t move_count = generate_legal_moves(position, move_list);
+
+    // We order the candidate moves by the number of replies the defender has, as moves that leave the defender fewer
+    // options are both more likely to mate and cheaper to refute. Checks come before quiet moves, and a mate in one is
+    // only possible with a check, so we only need to consider checks when a single move is left.
+    Move candidates[MAX_MOVES];
+    size_t reply_counts[MAX_MOVES];
+    size_t candidate_count = 0;
+
+    struct PositionInfo info;
+    Move reply_list[MAX_MOVES];
+    for (size_t i = 0; i < move_count; ++i) {
+        const Move move = move_list[i];
+
+        size_t reply_count = MAX_MOVES;
+        if (gives_check(position, move)) {
+            do_move(position, &info, move);
+            reply_count = generate_legal_moves(position, reply_list);
+            const bool mate = reply_count == 0;
+            undo_move(position, move);
+
+            // There is no shorter mate than this one, so we do not need to look any further.
+            if (mate) {
+                searcher->principal_variation_length[ply + 1] = 0;
+                update_principal_variation(searcher, ply, move);
+                return true;
+            }
+        } else if (moves_left == 1) {
+            continue;
+        }
+
+        // Insertion sort, such that moves with the same number of replies stay in move generation order.
+        size_t j = candidate_count++;
+        for (; j > 0 && reply_counts[j - 1] > reply_count; --j) {
+            candidates[j]   = candidates[j - 1];
+            reply_counts[j] = reply_counts[j - 1];
+        }
+        candidates[j]   = move;
+        reply_counts[j] = reply_count;
+    }
+
+    // All mates in one have been found above.
+    if (moves_left == 1)
+        return false;
+
+    for (size_t i = 0; i < candidate_count; ++i) {
+        do_move(position, &info, candidates[i]);
+
+        const bool mates = defender_is_mated(searcher, position, moves_left, ply + 1);
+
+        undo_move(position, candidates[i]);
+
+        if (mates) {
+            update_principal_variation(searcher, ply, candidates[i]);
+            return true;
+        }
+
+        if (atomic_load(&searcher->thread_pool->stop_search))
+            return false;
+    }
+
+    return false;
+}
+
+
+void mate_search(struct Searcher* searcher) {
+    assert(searcher != nullptr);
+
+    const uint64_t start_time = get_time_us();
+
+    // Every move consists of two plies, which must all fit in the principal variation table.
+    size_t max_moves = searcher->thread_pool->search_arguments->mate_in_x;
+    if (max_moves > MAX_SEARCH_DEPTH / 2 - 1)
+        max_moves = MAX_SEARCH_DEPTH / 2 - 1;
+
+    struct PositionInfo info;
+    for (size_t moves = 1; moves <= max_moves; ++moves) {
+        for (size_t i = 0; i < searcher->root_move_count; ++i) {
+            struct RootMove* root_move = &searcher->root_moves[i];
+
+            // A mate in one is only possible with a check.
+            if (moves == 1 && !gives_check(&searcher->root_position, root_move->move))
+                continue;
+
+            do_move(&searcher->root_position, &info, root_move->move);
+
+            const bool mates = defender_is_mated(searcher, &searcher->root_position, moves, 1);
+
+            undo_move(&searcher->root_position, root_move->move);
+
+            if (mate_search_stopped(searcher)) {
+                uci_no_mate_info(moves - 1, searcher->nodes_searched, get_time_us() - start_time);
+                return;
+            }
+
+            if (!mates)
+                continue;
+
+            const size_t plies = 2 * moves - 1;
+
+            root_move->value = mate_value(plies);
+            root_move->depth = plies;
+            memcpy(&root_move->principal_variation[1], &searcher->principal_variation_table[1][0],
+                   searcher->principal_variation_length[1] * sizeof(Move));
+            root_move->principal_variation_length = searcher->principal_variation_length[1] + 1;
+
+            // Move the mating move to the front, such that it will be played.
+            const struct RootMove mating_move = *root_move;
+            memmove(&searcher->root_moves[1], &searcher->root_moves[0], i * sizeof(*searcher->root_moves));
+            searcher->root_moves[0] = mating_move;
+            atomic_store(&searcher->best_value, mating_move.value);
+
+            const uint64_t elapsed_time = get_time_us() - start_time;
+            uci_long_info(plies, 1, mating_move.value, searcher->nodes_searched,
+                          atomic_load(&searcher->tablebase_hits), elapsed_time, mating_move.principal_variation,
+                          mating_move.principal_variation_length);
+            return;
+        }
+    }
+
+    // The best move is the first root move, which has not been searched.
+    uci_no_mate_info(max_moves, searcher->nodes_searched, get_time_us() - start_time);
+}
@@ -0,0 +1,17 @@
+#ifndef WINDMOLEN_MATE_SEARCH_H_
+#define WINDMOLEN_MATE_SEARCH_H_
+
+
+#include "search.h"
+
+
+
+// Makes `searcher` search its root position for a forced mate in at most `mate_in_x` moves of the search arguments.
+// Mates are searched from short to long, such that the first mate found is also the shortest mate. If a mate is found,
+// the mating root move is moved to the front of the root moves of `searcher` and reported to UCI. Otherwise, the number
+// of moves for which no mate exists is reported.
+void mate_search(struct Searcher* searcher);
+
+
+
+#endif /* #ifndef WINDMOLEN_MATE_SEARCH_H_ */
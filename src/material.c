@@ -0,0 +1,131 @@
+#include "material.h"
+
+#include <assert.h>
+#include <stddef.h>
+
+#include "endgame.h"
+#include "piece.h"
+#include "position.h"
+#include "score.h"
+#include "util.h"
+
+
+
+// Material in units of pawns, only used to recognize material configurations.
+static const int piece_units[PIECE_TYPE_COUNT] = {
+    [PIECE_TYPE_KNIGHT] = 3, [PIECE_TYPE_BISHOP] = 3, [PIECE_TYPE_ROOK] = 5, [PIECE_TYPE_QUEEN] = 9,
+};
+static constexpr int MINOR_PIECE_UNITS = 3;
+static constexpr int ROOK_UNITS        = 5;
+
+
+// Returns the non-pawn material of `color` in `position` in units of pawns.
+static int non_pawn_units(const struct Position* position, const enum Color color) {
+    assert(position != nullptr);
+    assert(is_valid_color(color));
+
+    int units = 0;
+    for (enum PieceType piece_type = PIECE_TYPE_KNIGHT; piece_type < PIECE_TYPE_KING; ++piece_type)
+        units += piece_units[piece_type] * popcount64(piece_occupancy(position, color, piece_type));
+
+    return units;
+}
+
+// Returns whether `color` has only its king left in `position`.
+static INLINE bool is_lone_king(const struct Position* position, const enum Color color) {
+    assert(position != nullptr);
+    assert(is_valid_color(color));
+
+    return popcount64(piece_occupancy_by_color(position, color)) == 1;
+}
+
+// Returns the specialized endgame function of `strong_side` against a lone king in `position`, or nullptr if there is
+// none.
+static EndgameFunction lone_king_endgame(const struct Position* position, const enum Color strong_side) {
+    assert(position != nullptr);
+    assert(is_valid_color(strong_side));
+
+    const int pawns   = popcount64(piece_occupancy(position, strong_side, PIECE_TYPE_PAWN));
+    const int knights = popcount64(piece_occupancy(position, strong_side, PIECE_TYPE_KNIGHT));
+    const int bishops = popcount64(piece_occupancy(position, strong_side, PIECE_TYPE_BISHOP));
+    const int units   = non_pawn_units(position, strong_side);
+
+    if (units == 0 && pawns == 1)
+        return evaluate_kpk;
+
+    if (pawns == 0 && knights == 1 && bishops == 1 && units == 2 * MINOR_PIECE_UNITS)
+        return evaluate_kbnk;
+
+    // Two knights cannot force mate, and two bishops might be on the same color.
+    if (units >= ROOK_UNITS && (units != 2 * MINOR_PIECE_UNITS || bishops == 1))
+        return evaluate_kxk;
+
+    return nullptr;
+}
+
+// Computes the entry of the material configuration of `position`.
+static void compute_material_entry(struct MaterialEntry* entry, const struct Position* position) {
+    assert(entry != nullptr);
+    assert(position != nullptr);
+
+    entry->game_phase  = (position->info->game_phase > MAX_GAME_PHASE) ? MAX_GAME_PHASE : position->info->game_phase;
+    entry->endgame     = nullptr;
+    entry->strong_side = COLOR_WHITE;
+
+    const int white_pawns = popcount64(piece_occupancy(position, COLOR_WHITE, PIECE_TYPE_PAWN));
+    const int black_pawns = popcount64(piece_occupancy(position, COLOR_BLACK, PIECE_TYPE_PAWN));
+    const int white_units = non_pawn_units(position, COLOR_WHITE);
+    const int black_units = non_pawn_units(position, COLOR_BLACK);
+
+    // Without pawns, a single minor piece cannot mate, not even with help of the opponent if it has nothing else.
+    entry->draw = white_pawns == 0 && black_pawns == 0 && white_units + black_units <= MINOR_PIECE_UNITS;
+
+    for (enum Color color = COLOR_WHITE; color < COLOR_COUNT; ++color) {
+        const enum Color opponent = opposite_color(color);
+
+        if (!entry->draw && is_lone_king(position, opponent)) {
+            const EndgameFunction endgame = lone_king_endgame(position, color);
+            if (endgame != nullptr) {
+                entry->endgame     = endgame;
+                entry->strong_side = color;
+            }
+        }
+
+        // A side without pawns needs more than a minor piece extra to be able to win.
+        const int pawns       = (color == COLOR_WHITE) ? white_pawns : black_pawns;
+        const int units       = (color == COLOR_WHITE) ? white_units : black_units;
+        const int their_units = (color == COLOR_WHITE) ? black_units : white_units;
+
+        if (pawns == 0 && units <= MINOR_PIECE_UNITS)
+            entry->scale_factors[color] = SCALE_FACTOR_DRAW;
+        else if (pawns == 0 && units - their_units <= MINOR_PIECE_UNITS)
+            entry->scale_factors[color] = SCALE_FACTOR_DRAWISH;
+        else
+            entry->scale_factors[color] = SCALE_FACTOR_NORMAL;
+    }
+}
+
+
+void clear_material_table(struct MaterialTable* material_table) {
+    assert(material_table != nullptr);
+
+    // No position has a material key of 0, as there are always kings on the board. So an empty entry never matches.
+    for (size_t i = 0; i < MATERIAL_TABLE_SIZE; ++i)
+        material_table->entries[i].key = 0;
+}
+
+const struct MaterialEntry* probe_material_table(struct MaterialTable* material_table,
+                                                 const struct Position* position) {
+    assert(material_table != nullptr);
+    assert(position != nullptr);
+
+    const ZobristKey key        = material_key(position);
+    struct MaterialEntry* entry = &material_table->entries[key & (MATERIAL_TABLE_SIZE - 1)];
+
+    if (entry->key != key) {
+        entry->key = key;
+        compute_material_entry(entry, position);
+    }
+
+    return entry;
+}
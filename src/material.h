@@ -0,0 +1,59 @@
+#ifndef WINDMOLEN_MATERIAL_H_
+#define WINDMOLEN_MATERIAL_H_
+
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "endgame.h"
+#include "piece.h"
+#include "position.h"
+#include "score.h"
+#include "zobrist.h"
+
+
+
+// The number of entries in a material table, which must be a power of two.
+static constexpr size_t MATERIAL_TABLE_SIZE = 1 << 13;
+static_assert((MATERIAL_TABLE_SIZE & (MATERIAL_TABLE_SIZE - 1)) == 0);
+
+// The value of a side is multiplied by its scale factor and divided by SCALE_FACTOR_NORMAL. A side that has the better
+// position, but few winning chances because of its material, gets a lower scale factor.
+static constexpr uint8_t SCALE_FACTOR_NORMAL  = 64;
+static constexpr uint8_t SCALE_FACTOR_DRAWISH = 16;
+static constexpr uint8_t SCALE_FACTOR_DRAW    = 0;
+
+// An entry of the material table contains everything about a material configuration that does not depend on where the
+// pieces are.
+struct MaterialEntry {
+    ZobristKey key;
+
+    // The game phase, capped at MAX_GAME_PHASE in case of promotions.
+    int game_phase;
+
+    // Whether neither side can possibly mate, in which case the position is a dead draw.
+    bool draw;
+
+    // The specialized endgame function for this material configuration, if any.
+    EndgameFunction endgame;
+    enum Color strong_side;
+
+    uint8_t scale_factors[COLOR_COUNT];
+};
+
+// The material table is a thread local hash table of material entries, indexed by the material key of a position.
+struct MaterialTable {
+    struct MaterialEntry entries[MATERIAL_TABLE_SIZE];
+};
+
+
+// Removes all entries from `material_table`.
+void clear_material_table(struct MaterialTable* material_table);
+
+// Returns the entry of the material configuration of `position`, which is computed if it is not in `material_table`
+// yet.
+const struct MaterialEntry* probe_material_table(struct MaterialTable* material_table, const struct Position* position);
+
+
+
+#endif /* #ifndef WINDMOLEN_MATERIAL_H_ */
@@ -0,0 +1,252 @@
+#include <assert.h>
+#include <math.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "bench.h"
+#include "bitbase.h"
+#include "bitboard.h"
+#include "constants.h"
+#include "evaluation.h"
+#include "material.h"
+#include "move.h"
+#include "move_generation.h"
+#include "move_picker.h"
+#include "nnue.h"
+#include "nnue_kernels.h"
+#include "pawns.h"
+#include "position.h"
+#include "time_manager.h"
+#include "zobrist.h"
+
+
+
+// The number of timed samples per microbenchmark, from which the mean and the standard deviation are computed.
+static constexpr size_t MICROBENCH_SAMPLE_COUNT = 10;
+
+// The minimum duration of a sample in microseconds. Short samples are dominated by the resolution of the timer.
+static constexpr uint64_t MICROBENCH_MIN_SAMPLE_TIME = 50000;
+
+
+// The positions the microbenchmarks run over. Every bench position is set up once as a root position, together with its
+// legal moves, and once as the child position after its first legal move, which is used to benchmark the incremental
+// evaluation.
+struct Corpus {
+    struct Position roots[BENCH_POSITION_COUNT];
+    struct PositionInfo root_infos[BENCH_POSITION_COUNT];
+    Move moves[BENCH_POSITION_COUNT][MAX_MOVES];
+    size_t move_counts[BENCH_POSITION_COUNT];
+
+    struct Position children[BENCH_POSITION_COUNT];
+    struct PositionInfo child_infos[BENCH_POSITION_COUNT][2];
+
+    struct Evaluator evaluator;
+    struct PawnTable pawn_table;
+    struct MaterialTable material_table;
+};
+
+// A microbenchmark performs a single pass over the corpus and returns the number of operations it performed.
+struct Microbenchmark {
+    const char* name;
+    size_t (*pass)(struct Corpus* corpus);
+};
+
+// The results of the microbenchmarks are accumulated here, such that the compiler cannot remove the benchmarked calls.
+static volatile uint64_t sink;
+
+
+static size_t generate_legal_moves_pass(struct Corpus* corpus) {
+    assert(corpus != nullptr);
+
+    Move movelist[MAX_MOVES];
+    for (size_t i = 0; i < BENCH_POSITION_COUNT; ++i)
+        sink += generate_legal_moves(&corpus->roots[i], movelist);
+
+    return BENCH_POSITION_COUNT;
+}
+
+static size_t generate_legal_captures_pass(struct Corpus* corpus) {
+    assert(corpus != nullptr);
+
+    Move capture_list[MAX_MOVES];
+    for (size_t i = 0; i < BENCH_POSITION_COUNT; ++i)
+        sink += generate_legal_captures(&corpus->roots[i], capture_list);
+
+    return BENCH_POSITION_COUNT;
+}
+
+static size_t do_undo_move_pass(struct Corpus* corpus) {
+    assert(corpus != nullptr);
+
+    size_t operations = 0;
+    struct PositionInfo position_info;
+    for (size_t i = 0; i < BENCH_POSITION_COUNT; ++i) {
+        for (size_t j = 0; j < corpus->move_counts[i]; ++j) {
+            do_move(&corpus->roots[i], &position_info, corpus->moves[i][j]);
+            undo_move(&corpus->roots[i], corpus->moves[i][j]);
+        }
+
+        operations += corpus->move_counts[i];
+    }
+
+    return operations;
+}
+
+static size_t evaluate_position_pass(struct Corpus* corpus) {
+    assert(corpus != nullptr);
+
+    for (size_t i = 0; i < BENCH_POSITION_COUNT; ++i) {
+        // The accumulators are updated from the root position again every time, as they would be in a search.
+        struct Position* child                         = &corpus->children[i];
+        child->info->accumulator.computed[COLOR_WHITE] = false;
+        child->info->accumulator.computed[COLOR_BLACK] = false;
+
+        sink += (uint64_t)evaluate_position(&corpus->evaluator, &corpus->pawn_table, &corpus->material_table, child);
+    }
+
+    return BENCH_POSITION_COUNT;
+}
+
+static size_t slider_attacks_pass(struct Corpus* corpus) {
+    assert(corpus != nullptr);
+
+    Bitboard attacks = EMPTY_BITBOARD;
+    for (size_t i = 0; i < BENCH_POSITION_COUNT; ++i) {
+        const Bitboard occupancy = corpus->roots[i].total_occupancy;
+        for (enum Square square = SQUARE_A1; square <= SQUARE_H8; ++square)
+            attacks ^= bishop_attacks(square, occupancy) ^ rook_attacks(square, occupancy);
+    }
+    sink += attacks;
+
+    return 2 * SQUARE_COUNT * BENCH_POSITION_COUNT;
+}
+
+static size_t mvv_lva_pick_move_pass(struct Corpus* corpus) {
+    assert(corpus != nullptr);
+
+    Move movelist[MAX_MOVES];
+    int8_t move_values[MAX_MOVES];
+    for (size_t i = 0; i < BENCH_POSITION_COUNT; ++i) {
+        const size_t move_count = corpus->move_counts[i];
+        memcpy(movelist, corpus->moves[i], move_count * sizeof(*movelist));
+
+        compute_mvv_lva_values(&corpus->roots[i], movelist, move_count, move_values);
+        for (size_t j = 0; j < move_count; ++j)
+            sink += pick_move(movelist, move_values, move_count, j);
+    }
+
+    return BENCH_POSITION_COUNT;
+}
+
+static size_t setup_position_from_fen_pass([[maybe_unused]] struct Corpus* corpus) {
+    assert(corpus != nullptr);
+
+    struct Position position;
+    struct PositionInfo position_info;
+    for (size_t i = 0; i < BENCH_POSITION_COUNT; ++i) {
+        setup_position_from_fen(&position, &position_info, bench_positions[i]);
+        sink += zobrist_key(&position);
+    }
+
+    return BENCH_POSITION_COUNT;
+}
+
+static const struct Microbenchmark microbenchmarks[] = {
+    {"generate_legal_moves (per position)", generate_legal_moves_pass},
+    {"generate_legal_captures (per position)", generate_legal_captures_pass},
+    {"do_move+undo_move (per move)", do_undo_move_pass},
+    {"evaluate_position (per position)", evaluate_position_pass},
+    {"bishop_attacks/rook_attacks (per call)", slider_attacks_pass},
+    {"compute_mvv_lva_values+pick_move (per list)", mvv_lva_pick_move_pass},
+    {"setup_position_from_fen (per position)", setup_position_from_fen_pass},
+};
+
+static constexpr size_t MICROBENCHMARK_COUNT = sizeof(microbenchmarks) / sizeof(*microbenchmarks);
+
+
+// Sets up the root and child positions of `corpus` and resets its evaluation tables.
+static void setup_corpus(struct Corpus* corpus) {
+    assert(corpus != nullptr);
+
+    reset_evaluator(&corpus->evaluator, current_network());
+    clear_pawn_table(&corpus->pawn_table);
+    clear_material_table(&corpus->material_table);
+
+    for (size_t i = 0; i < BENCH_POSITION_COUNT; ++i) {
+        setup_position_from_fen(&corpus->roots[i], &corpus->root_infos[i], bench_positions[i]);
+        corpus->move_counts[i] = generate_legal_moves(&corpus->roots[i], corpus->moves[i]);
+        assert(corpus->move_counts[i] > 0);
+
+        // The child is evaluated incrementally from the accumulators of its root, so those are computed here.
+        struct Position* child = &corpus->children[i];
+        setup_position_from_fen(child, &corpus->child_infos[i][0], bench_positions[i]);
+        refresh_accumulators(&corpus->evaluator, child);
+        do_move(child, &corpus->child_infos[i][1], corpus->moves[i][0]);
+    }
+}
+
+// Times `microbenchmark` over `corpus` and prints the mean time per operation, its standard deviation relative to the
+// mean and the fastest sample.
+static void run_microbenchmark(const struct Microbenchmark* microbenchmark, struct Corpus* corpus) {
+    assert(microbenchmark != nullptr);
+    assert(corpus != nullptr);
+
+    // The number of passes per sample is doubled until a sample takes long enough. This also warms up the caches.
+    size_t pass_count = 1;
+    while (true) {
+        const uint64_t start_time = get_time_us();
+        for (size_t i = 0; i < pass_count; ++i)
+            microbenchmark->pass(corpus);
+
+        if (get_time_us() - start_time >= MICROBENCH_MIN_SAMPLE_TIME)
+            break;
+
+        pass_count *= 2;
+    }
+
+    double samples[MICROBENCH_SAMPLE_COUNT];
+    for (size_t i = 0; i < MICROBENCH_SAMPLE_COUNT; ++i) {
+        size_t operations         = 0;
+        const uint64_t start_time = get_time_us();
+        for (size_t j = 0; j < pass_count; ++j)
+            operations += microbenchmark->pass(corpus);
+
+        samples[i] = 1000.0 * (double)(get_time_us() - start_time) / (double)operations;
+    }
+
+    double mean = 0.0;
+    double min  = samples[0];
+    for (size_t i = 0; i < MICROBENCH_SAMPLE_COUNT; ++i) {
+        mean += samples[i] / MICROBENCH_SAMPLE_COUNT;
+        min = (samples[i] < min) ? samples[i] : min;
+    }
+
+    double variance = 0.0;
+    for (size_t i = 0; i < MICROBENCH_SAMPLE_COUNT; ++i)
+        variance += (samples[i] - mean) * (samples[i] - mean) / (MICROBENCH_SAMPLE_COUNT - 1);
+
+    printf("%-46s %10.2f ns/op  +-%6.2f%%  min %10.2f ns/op\n", microbenchmark->name, mean,
+           100.0 * sqrt(variance) / mean, min);
+}
+
+
+int main(void) {
+    initialize_bitboards();
+    initialize_kpk_bitbase();
+    initialize_zobrist_keys();
+    initialize_default_network();
+    select_nnue_kernels();
+
+    // The corpus is too large for the stack.
+    static struct Corpus corpus;
+    setup_corpus(&corpus);
+
+    printf("%zu positions, %zu samples per microbenchmark, %s NNUE kernels\n\n", BENCH_POSITION_COUNT,
+           MICROBENCH_SAMPLE_COUNT, nnue_kernels.name);
+    for (size_t i = 0; i < MICROBENCHMARK_COUNT; ++i)
+        run_microbenchmark(&microbenchmarks[i], &corpus);
+
+    return 0;
+}
@@ -638,6 +638,152 @@ static bool is_legal_en_passant(const struct Position* position, const Move move
 }
 
 
+// Returns the number of pawn moves with a destination in the `pawn_moves` bitboard, where a move to the promotion rank
+// counts for every promotion piece.
+static INLINE size_t count_pawn_destinations(const Bitboard pawn_moves) {
+    constexpr Bitboard PROMOTION_RANKS = RANK_1_BITBOARD | RANK_8_BITBOARD;
+
+    return (size_t)popcount64(pawn_moves & ~PROMOTION_RANKS) + 4 * (size_t)popcount64(pawn_moves & PROMOTION_RANKS);
+}
+
+// Returns the number of moves of the `pawns` of `side_to_move` in `position` that end on a square of `allowed`. En
+// passant captures are not included.
+static INLINE size_t count_pawn_moves(const struct Position* position, const enum Color side_to_move,
+                                      const Bitboard pawns, const Bitboard allowed) {
+    assert(position != nullptr);
+
+    const bool white                = side_to_move == COLOR_WHITE;
+    const enum Direction forward    = white ? DIRECTION_NORTH : DIRECTION_SOUTH;
+    const Bitboard double_push_rank = white ? RANK_3_BITBOARD : RANK_6_BITBOARD;
+    const Bitboard empty_squares    = ~position->total_occupancy;
+    const Bitboard enemies          = piece_occupancy_by_color(position, opposite_color(side_to_move)) & allowed;
+
+    // As in move generation, the double pushes follow from the single pushes before those are masked with `allowed`.
+    const Bitboard push_once    = shift_bitboard(pawns, forward) & empty_squares;
+    const Bitboard push_twice   = shift_bitboard(push_once & double_push_rank, forward) & empty_squares & allowed;
+    const Bitboard attacks_east = shift_bitboard(pawns, white ? DIRECTION_NORTHEAST : DIRECTION_SOUTHEAST) & enemies;
+    const Bitboard attacks_west = shift_bitboard(pawns, white ? DIRECTION_NORTHWEST : DIRECTION_SOUTHWEST) & enemies;
+
+    return count_pawn_destinations(push_once & allowed) + (size_t)popcount64(push_twice)
+         + count_pawn_destinations(attacks_east) + count_pawn_destinations(attacks_west);
+}
+
+// Returns the number of legal moves for `side_to_move` in `position`. Instead of generating pseudolegal moves and
+// filtering them, the destination bitboards are restricted to legal destinations up front and counted. Only king moves
+// and en passant captures are tested one by one.
+static INLINE size_t count_legal_moves_by_color(const struct Position* position, const enum Color side_to_move) {
+    assert(position != nullptr);
+    assert(position->side_to_move == side_to_move);
+
+    const enum Color opponent     = opposite_color(side_to_move);
+    const Bitboard friendly       = piece_occupancy_by_color(position, side_to_move);
+    const enum Square king        = king_square(position, side_to_move);
+    const Bitboard occupancy      = position->total_occupancy;
+    const Bitboard pinned         = position->info->blockers[side_to_move] & friendly;
+    const Bitboard checkers       = position->info->checkers;
+    const Bitboard promotion_rank = (side_to_move == COLOR_WHITE) ? RANK_7_BITBOARD : RANK_2_BITBOARD;
+
+
+    /* King moves. */
+    size_t count = 0;
+
+    // The king is removed from the occupancy for the case where the destination square lies on the same line as the
+    // attacker.
+    const Bitboard occupancy_without_king = occupancy ^ king_occupancy(position, side_to_move);
+
+    Bitboard king_moves = piece_base_attacks(PIECE_TYPE_KING, king) & ~friendly;
+    while (king_moves != EMPTY_BITBOARD)
+        count += !square_is_attacked(position, opponent, (enum Square)pop_lsb64(&king_moves), occupancy_without_king);
+
+    // If we are in double check, only non-castling king moves can get us out of check.
+    if (popcount64_greater_than_one(checkers))
+        return count;
+
+    Bitboard target = ~friendly;
+    if (checkers == EMPTY_BITBOARD) {
+        /* Castling moves. */
+        const bool white                          = side_to_move == COLOR_WHITE;
+        const enum CastlingRights castling_rights = position->info->castling_rights
+                                                  & (white ? CASTLE_WHITE : CASTLE_BLACK);
+        if (castling_rights != CASTLE_NONE) {
+            const bool king_side_unobstructed  = white ? white_king_side_unobstructed(position)
+                                                       : black_king_side_unobstructed(position);
+            const bool queen_side_unobstructed = white ? white_queen_side_unobstructed(position)
+                                                       : black_queen_side_unobstructed(position);
+
+            if ((castling_rights & CASTLE_KING_SIDE) != CASTLE_NONE && king_side_unobstructed)
+                count += is_legal_king_move(position, new_castle(side_to_move, CASTLE_KING_SIDE));
+            if ((castling_rights & CASTLE_QUEEN_SIDE) != CASTLE_NONE && queen_side_unobstructed)
+                count += is_legal_king_move(position, new_castle(side_to_move, CASTLE_QUEEN_SIDE));
+        }
+    } else {
+        // Every other move has to interpose the check or capture the checker, see white_pseudolegal_moves().
+        target = between_bitboard(king, (enum Square)lsb64(checkers));
+    }
+
+
+    /* Pawn moves. */
+    const Bitboard friendly_pawns = piece_occupancy(position, side_to_move, PIECE_TYPE_PAWN);
+    count += count_pawn_moves(position, side_to_move, friendly_pawns & ~pinned, target);
+
+    // A pinned piece is only allowed to move on the line through the king. If we are in check, this line never crosses
+    // the target, so pinned pieces cannot move at all.
+    Bitboard pinned_pawns = friendly_pawns & pinned;
+    while (pinned_pawns != EMPTY_BITBOARD) {
+        const enum Square pawn_square = (enum Square)pop_lsb64(&pinned_pawns);
+        count += count_pawn_moves(position, side_to_move, square_bitboard(pawn_square),
+                                  target & line_bitboard(king, pawn_square));
+    }
+
+    /* En passant. */
+    const enum Square en_passant = en_passant_square(position);
+    if (en_passant != SQUARE_NONE) {
+        // A pawn attacks the en passant square if an enemy pawn on the en passant square would be attacking that pawn.
+        Bitboard en_passant_attackers = friendly_pawns & ~promotion_rank
+                                      & piece_base_attacks(pawn_type_from_color(opponent), en_passant);
+
+        while (en_passant_attackers != EMPTY_BITBOARD) {
+            const enum Square source = (enum Square)pop_lsb64(&en_passant_attackers);
+            const Move move          = new_move(source, en_passant, MOVE_TYPE_EN_PASSANT);
+
+            count += ((pinned & square_bitboard(source)) == EMPTY_BITBOARD || is_legal_pinned_move(position, move))
+                  && is_legal_en_passant(position, move);
+        }
+    }
+
+
+    /* Knight moves. */
+    // Pinned knights can never move, as they cannot stay on the line through the king.
+    Bitboard knights = piece_occupancy(position, side_to_move, PIECE_TYPE_KNIGHT) & ~pinned;
+    while (knights != EMPTY_BITBOARD)
+        count += (size_t)popcount64(piece_base_attacks(PIECE_TYPE_KNIGHT, (enum Square)pop_lsb64(&knights)) & target);
+
+
+    /* Bishop/Queen moves. */
+    Bitboard bishops_and_queens = bishop_queen_occupancy(position, side_to_move);
+    while (bishops_and_queens != EMPTY_BITBOARD) {
+        const enum Square piece_square = (enum Square)pop_lsb64(&bishops_and_queens);
+        const Bitboard allowed         = ((pinned & square_bitboard(piece_square)) != EMPTY_BITBOARD)
+                                         ? target & line_bitboard(king, piece_square)
+                                         : target;
+        count += (size_t)popcount64(bishop_attacks(piece_square, occupancy) & allowed);
+    }
+
+
+    /* Rook/Queen moves. */
+    Bitboard rooks_and_queens = rook_queen_occupancy(position, side_to_move);
+    while (rooks_and_queens != EMPTY_BITBOARD) {
+        const enum Square piece_square = (enum Square)pop_lsb64(&rooks_and_queens);
+        const Bitboard allowed         = ((pinned & square_bitboard(piece_square)) != EMPTY_BITBOARD)
+                                         ? target & line_bitboard(king, piece_square)
+                                         : target;
+        count += (size_t)popcount64(rook_attacks(piece_square, occupancy) & allowed);
+    }
+
+    return count;
+}
+
+
 size_t generate_legal_captures(const struct Position* position, Move capture_list[static MAX_MOVES]) {
     assert(position != nullptr);
     assert(capture_list != nullptr);
@@ -701,3 +847,12 @@ size_t generate_legal_moves(const struct Position* position, Move movelist[stati
 
     return size;
 }
+
+size_t count_legal_moves(const struct Position* position) {
+    assert(position != nullptr);
+
+    // The color is passed as a constant, such that all color dependent directions and ranks are resolved at compile
+    // time.
+    return (position->side_to_move == COLOR_WHITE) ? count_legal_moves_by_color(position, COLOR_WHITE)
+                                                   : count_legal_moves_by_color(position, COLOR_BLACK);
+}
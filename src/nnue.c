@@ -0,0 +1,402 @@
+#include "nnue.h"
+
+#include <assert.h>
+#include <fcntl.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "accumulator.h"
+#include "bitboard.h"
+#include "board.h"
+#include "constants.h"
+#include "nnue_kernels.h"
+#include "piece.h"
+#include "position.h"
+#include "score.h"
+#include "util.h"
+
+
+
+static struct Network default_network;
+static const struct Network* active_network = &default_network;
+
+// The generation of the active network, which changes whenever the network is replaced. A loaded network may be mapped
+// at the address of an earlier one, so the address does not identify a network.
+static uint64_t active_network_generation = 1;
+
+// The memory mapping of the loaded network file, if any.
+static void* mapped_file   = nullptr;
+static size_t mapped_size = 0;
+
+
+// Returns the king bucket of the king of `perspective` on `king`. The buckets distinguish between a king on the
+// queenside or kingside, and a king on its first two ranks or further up the board.
+static INLINE size_t king_bucket(const enum Color perspective, const enum Square king) {
+    assert(is_valid_color(perspective));
+    assert(is_valid_square(king));
+
+    const enum Square oriented_king = (perspective == COLOR_WHITE) ? king : (enum Square)(king ^ 56);
+
+    return (rank_of_square(oriented_king) >= RANK_3 ? 2U : 0U) + (file_of_square(oriented_king) >= FILE_E ? 1U : 0U);
+}
+
+// Returns the index of the feature of `piece` on `square` for `perspective` with its king in `bucket`. The board is
+// flipped for black, such that both perspectives see their own pieces from the bottom of the board.
+static INLINE size_t feature_index(const enum Color perspective, const size_t bucket, const enum Piece piece,
+                                   const enum Square square) {
+    assert(is_valid_color(perspective));
+    assert(bucket < NNUE_KING_BUCKET_COUNT);
+    assert(is_valid_piece(piece));
+    assert(is_valid_square(square));
+
+    const size_t piece_slot      = type_of_piece(piece) + ((color_of_piece(piece) == perspective) ? 0U : 6U);
+    const size_t oriented_square   = (perspective == COLOR_WHITE) ? square : (square ^ 56);
+
+    return (bucket * NNUE_PIECE_SLOT_COUNT + piece_slot) * SQUARE_COUNT + oriented_square;
+}
+
+// Returns the output bucket of `game_phase`, which must be at most MAX_GAME_PHASE. The game phases are divided evenly
+// over the buckets.
+static INLINE size_t game_phase_bucket(const int game_phase) {
+    assert(game_phase >= 0 && game_phase <= MAX_GAME_PHASE);
+
+    return (size_t)game_phase * NNUE_OUTPUT_BUCKET_COUNT / (MAX_GAME_PHASE + 1);
+}
+
+// Returns the output bucket of `position`, which is determined by its game phase.
+static INLINE size_t output_bucket(const struct Position* position) {
+    assert(position != nullptr);
+
+    int game_phase = position->info->game_phase;
+    if (game_phase > MAX_GAME_PHASE)
+        game_phase = MAX_GAME_PHASE;  // In case of an early promotion.
+
+    return game_phase_bucket(game_phase);
+}
+
+
+// The maximum number of features that change in a refresh, which is bounded by the number of pieces on the board.
+static constexpr size_t MAX_REFRESH_FEATURES = 32;
+
+
+// Computes the accumulator of `perspective` of `position` from the refresh table entry of its king bucket, and updates
+// that entry to the pieces of `position`.
+static void refresh_accumulator(struct Evaluator* evaluator, const struct Position* position,
+                                const enum Color perspective) {
+    assert(evaluator != nullptr);
+    assert(position != nullptr);
+    assert(is_valid_color(perspective));
+
+    const enum Square king     = king_square(position, perspective);
+    const size_t bucket        = king_bucket(perspective, king);
+    struct RefreshEntry* entry = &evaluator->refresh_table[perspective][bucket];
+
+    size_t added_features[MAX_REFRESH_FEATURES];
+    size_t removed_features[MAX_REFRESH_FEATURES];
+    size_t added_count   = 0;
+    size_t removed_count = 0;
+
+    for (enum Piece piece = PIECE_WHITE_PAWN; piece < PIECE_COUNT; ++piece) {
+        const Bitboard pieces = piece_occupancy(position, color_of_piece(piece), type_of_piece(piece));
+
+        Bitboard removed = entry->pieces[piece] & ~pieces;
+        while (removed != EMPTY_BITBOARD) {
+            const enum Square square = (enum Square)pop_lsb64(&removed);
+            assert(removed_count < MAX_REFRESH_FEATURES);
+            removed_features[removed_count++] = feature_index(perspective, bucket, piece, square);
+        }
+
+        Bitboard added = pieces & ~entry->pieces[piece];
+        while (added != EMPTY_BITBOARD) {
+            const enum Square square = (enum Square)pop_lsb64(&added);
+            assert(added_count < MAX_REFRESH_FEATURES);
+            added_features[added_count++] = feature_index(perspective, bucket, piece, square);
+        }
+
+        entry->pieces[piece] = pieces;
+    }
+
+    nnue_kernels.update_values(entry->values, evaluator->network->feature_weights, added_features, added_count,
+                               removed_features, removed_count);
+
+    struct Accumulator* accumulator = &position->info->accumulator;
+    memcpy(accumulator->values[perspective], entry->values, sizeof(entry->values));
+    accumulator->king_squares[perspective] = king;
+    accumulator->computed[perspective]     = true;
+}
+
+// Makes sure the accumulator of `perspective` of `position` is computed. We walk back to the last position with a
+// computed accumulator and apply the dirty pieces of all moves since then. This is not possible if the king changed
+// buckets or if the pieces that changed are not known, in which case we refresh the accumulator instead.
+static void update_accumulator(struct Evaluator* evaluator, const struct Position* position,
+                               const enum Color perspective) {
+    assert(evaluator != nullptr);
+    assert(position != nullptr);
+    assert(is_valid_color(perspective));
+
+    if (position->info->accumulator.computed[perspective])
+        return;
+
+    struct PositionInfo* infos[MAX_SEARCH_DEPTH];
+    size_t info_count = 0;
+
+    struct PositionInfo* info = position->info;
+    while (!info->accumulator.computed[perspective]) {
+        if (info->dirty_pieces.count > MAX_DIRTY_PIECES || info->previous_info == nullptr
+            || info_count == MAX_SEARCH_DEPTH) {
+            refresh_accumulator(evaluator, position, perspective);
+            return;
+        }
+
+        infos[info_count++] = info;
+        info                = info->previous_info;
+    }
+
+    enum Square king    = info->accumulator.king_squares[perspective];
+    const size_t bucket = king_bucket(perspective, king);
+    if (bucket != king_bucket(perspective, king_square(position, perspective))) {
+        refresh_accumulator(evaluator, position, perspective);
+        return;
+    }
+
+    const enum Piece our_king = create_piece(perspective, PIECE_TYPE_KING);
+
+    // We apply the moves from old to new. Positions along the way where the king is in the same bucket get their
+    // accumulator as well, such that sibling positions can start from them.
+    alignas(64) int16_t values[NNUE_HIDDEN_SIZE];
+    memcpy(values, info->accumulator.values[perspective], sizeof(values));
+    while (info_count > 0) {
+        info = infos[--info_count];
+
+        size_t added_features[MAX_DIRTY_PIECES];
+        size_t removed_features[MAX_DIRTY_PIECES];
+        size_t added_count   = 0;
+        size_t removed_count = 0;
+
+        const struct DirtyPieces* dirty_pieces = &info->dirty_pieces;
+        for (size_t i = 0; i < dirty_pieces->count; ++i) {
+            const enum Piece piece = dirty_pieces->pieces[i];
+
+            const enum Square source      = dirty_pieces->sources[i];
+            const enum Square destination = dirty_pieces->destinations[i];
+
+            if (source != SQUARE_NONE)
+                removed_features[removed_count++] = feature_index(perspective, bucket, piece, source);
+
+            if (destination != SQUARE_NONE) {
+                added_features[added_count++] = feature_index(perspective, bucket, piece, destination);
+
+                if (piece == our_king)
+                    king = destination;
+            }
+        }
+
+        // All changes of a move are applied in a single pass over the values.
+        nnue_kernels.update_values(values, evaluator->network->feature_weights, added_features, added_count,
+                                   removed_features, removed_count);
+
+        if (king_bucket(perspective, king) == bucket) {
+            memcpy(info->accumulator.values[perspective], values, sizeof(values));
+            info->accumulator.king_squares[perspective] = king;
+            info->accumulator.computed[perspective]     = true;
+        }
+    }
+
+    assert(position->info->accumulator.computed[perspective]);
+}
+
+
+void initialize_default_network() {
+    // The default network reproduces the tapered piece-square table evaluation. Our own pieces add their middle game
+    // and end game piece-square values to the first layer, so every neuron contains the total score of our pieces. The
+    // clipping only lets through a slice of NNUE_CLIP_MAX of that total, so we divide the range of the total score over
+    // many neurons with different biases, such that the clipped neurons together add up to the total score again.
+    constexpr size_t SLICE_COUNT = NNUE_HIDDEN_SIZE / 2;
+    constexpr int SLICE_BASE     = 8 * NNUE_CLIP_MAX;  // Allows negative totals, i.e. a lone king.
+
+    memset(&default_network, 0, sizeof(default_network));
+
+    for (size_t bucket = 0; bucket < NNUE_KING_BUCKET_COUNT; ++bucket) {
+        for (enum PieceType piece_type = PIECE_TYPE_PAWN; piece_type <= PIECE_TYPE_KING; ++piece_type) {
+            const enum Piece piece = create_piece(COLOR_WHITE, piece_type);
+
+            for (enum Square square = SQUARE_A1; square < SQUARE_COUNT; ++square) {
+                int16_t* weights = default_network.feature_weights[feature_index(COLOR_WHITE, bucket, piece, square)];
+
+                for (size_t i = 0; i < SLICE_COUNT; ++i) {
+                    weights[i]               = (int16_t)middle_game_value(piece_square_score[piece][square]);
+                    weights[SLICE_COUNT + i] = (int16_t)end_game_value(piece_square_score[piece][square]);
+                }
+            }
+        }
+    }
+
+    for (size_t i = 0; i < SLICE_COUNT; ++i) {
+        default_network.feature_biases[i]               = (int16_t)(SLICE_BASE - (int)i * NNUE_CLIP_MAX);
+        default_network.feature_biases[SLICE_COUNT + i] = (int16_t)(SLICE_BASE - (int)i * NNUE_CLIP_MAX);
+    }
+
+    // Each output bucket blends the middle game and end game score according to the average game phase of the bucket.
+    // The bases of both perspectives cancel out.
+    for (size_t bucket = 0; bucket < NNUE_OUTPUT_BUCKET_COUNT; ++bucket) {
+        int phase_sum   = 0;
+        int phase_count = 0;
+        for (int game_phase = 0; game_phase <= MAX_GAME_PHASE; ++game_phase) {
+            if (game_phase_bucket(game_phase) == bucket) {
+                phase_sum += game_phase;
+                ++phase_count;
+            }
+        }
+
+        const int middle_game_weight = (NNUE_OUTPUT_SCALE * phase_sum + MAX_GAME_PHASE / 2 * phase_count)
+                                     / (MAX_GAME_PHASE * phase_count);
+        const int end_game_weight    = NNUE_OUTPUT_SCALE - middle_game_weight;
+
+        int8_t* weights = default_network.output_weights[bucket];
+        for (size_t i = 0; i < SLICE_COUNT; ++i) {
+            weights[i]                                  = (int8_t)middle_game_weight;
+            weights[SLICE_COUNT + i]                    = (int8_t)end_game_weight;
+            weights[NNUE_HIDDEN_SIZE + i]               = (int8_t)-middle_game_weight;
+            weights[NNUE_HIDDEN_SIZE + SLICE_COUNT + i] = (int8_t)-end_game_weight;
+        }
+    }
+}
+
+const struct Network* current_network() {
+    return active_network;
+}
+
+uint64_t current_network_generation() {
+    return active_network_generation;
+}
+
+// Returns whether `header` describes a network of the architecture of this engine.
+static bool is_valid_header(const struct NetworkFileHeader* header) {
+    assert(header != nullptr);
+
+    return header->magic == NNUE_FILE_MAGIC && header->version == NNUE_FILE_VERSION
+           && header->feature_count == NNUE_FEATURE_COUNT && header->hidden_size == NNUE_HIDDEN_SIZE
+           && header->output_bucket_count == NNUE_OUTPUT_BUCKET_COUNT;
+}
+
+// Replaces the current network by `network`, which lives in the memory mapping `file` of `size` bytes, or in no mapping
+// if `file` is nullptr. The previous mapping is released.
+static void replace_network(const struct Network* network, void* file, const size_t size) {
+    assert(network != nullptr);
+
+    if (mapped_file != nullptr)
+        munmap(mapped_file, mapped_size);
+
+    active_network = network;
+    mapped_file    = file;
+    mapped_size    = size;
+    ++active_network_generation;
+}
+
+void use_default_network() {
+    replace_network(&default_network, nullptr, 0);
+}
+
+bool load_network(const char* path) {
+    assert(path != nullptr);
+
+    const int file_descriptor = open(path, O_RDONLY);
+    if (file_descriptor == -1)
+        return false;
+
+    constexpr size_t FILE_SIZE = sizeof(struct NetworkFileHeader) + sizeof(struct Network);
+
+    struct stat file_status;
+    if (fstat(file_descriptor, &file_status) == -1 || (size_t)file_status.st_size != FILE_SIZE) {
+        close(file_descriptor);
+        return false;
+    }
+
+    // The mapping stays valid after closing the file.
+    void* file = mmap(nullptr, FILE_SIZE, PROT_READ, MAP_SHARED, file_descriptor, 0);
+    close(file_descriptor);
+    if (file == MAP_FAILED)
+        return false;
+
+    if (!is_valid_header(file)) {
+        munmap(file, FILE_SIZE);
+        return false;
+    }
+
+    madvise(file, FILE_SIZE, MADV_WILLNEED);
+    replace_network((const struct Network*)((const char*)file + sizeof(struct NetworkFileHeader)), file, FILE_SIZE);
+    return true;
+}
+
+bool save_network(const char* path) {
+    assert(path != nullptr);
+
+    FILE* file = fopen(path, "wb");
+    if (file == nullptr)
+        return false;
+
+    // The padding of the header is written as well, so we clear it first.
+    struct NetworkFileHeader header;
+    memset(&header, 0, sizeof(header));
+    header.magic               = NNUE_FILE_MAGIC;
+    header.version             = NNUE_FILE_VERSION;
+    header.feature_count       = NNUE_FEATURE_COUNT;
+    header.hidden_size         = NNUE_HIDDEN_SIZE;
+    header.output_bucket_count = NNUE_OUTPUT_BUCKET_COUNT;
+
+    const bool written = fwrite(&header, sizeof(header), 1, file) == 1
+                         && fwrite(active_network, sizeof(*active_network), 1, file) == 1;
+
+    return fclose(file) == 0 && written;
+}
+
+
+void reset_evaluator(struct Evaluator* evaluator, const struct Network* network) {
+    assert(evaluator != nullptr);
+    assert(network != nullptr);
+
+    evaluator->network = network;
+
+    // Every entry starts as an empty board.
+    for (enum Color perspective = COLOR_WHITE; perspective < COLOR_COUNT; ++perspective) {
+        for (size_t bucket = 0; bucket < NNUE_KING_BUCKET_COUNT; ++bucket) {
+            struct RefreshEntry* entry = &evaluator->refresh_table[perspective][bucket];
+
+            memcpy(entry->values, network->feature_biases, sizeof(entry->values));
+            memset(entry->pieces, 0, sizeof(entry->pieces));
+        }
+    }
+}
+
+void refresh_accumulators(struct Evaluator* evaluator, const struct Position* position) {
+    assert(evaluator != nullptr);
+    assert(position != nullptr);
+
+    refresh_accumulator(evaluator, position, COLOR_WHITE);
+    refresh_accumulator(evaluator, position, COLOR_BLACK);
+}
+
+Value evaluate_network(struct Evaluator* evaluator, const struct Position* position) {
+    assert(evaluator != nullptr);
+    assert(position != nullptr);
+
+    update_accumulator(evaluator, position, COLOR_WHITE);
+    update_accumulator(evaluator, position, COLOR_BLACK);
+
+    const struct Accumulator* accumulator = &position->info->accumulator;
+    const size_t bucket                   = output_bucket(position);
+    const int8_t* weights                 = evaluator->network->output_weights[bucket];
+
+    const int16_t* us   = accumulator->values[position->side_to_move];
+    const int16_t* them = accumulator->values[opposite_color(position->side_to_move)];
+
+    const int32_t output = evaluator->network->output_biases[bucket]
+                         + nnue_kernels.output(us, them, weights, NNUE_CLIP_MAX);
+
+    return output / NNUE_OUTPUT_SCALE;
+}
@@ -0,0 +1,103 @@
+#ifndef WINDMOLEN_NNUE_H_
+#define WINDMOLEN_NNUE_H_
+
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "accumulator.h"
+#include "bitboard.h"
+#include "piece.h"
+#include "position.h"
+#include "score.h"
+
+
+
+// The network is an efficiently updatable neural network (NNUE) with HalfKA input features: every piece, including the
+// kings, on every square, relative to the king bucket of the perspective. The first layer is computed for both
+// perspectives, clipped and fed to an output layer that is selected by the game phase.
+static constexpr size_t NNUE_KING_BUCKET_COUNT   = 4;
+static constexpr size_t NNUE_PIECE_SLOT_COUNT    = 12;  // Our and their pawn, knight, bishop, rook, queen and king.
+static constexpr size_t NNUE_FEATURE_COUNT       = NNUE_KING_BUCKET_COUNT * NNUE_PIECE_SLOT_COUNT * SQUARE_COUNT;
+static constexpr size_t NNUE_OUTPUT_BUCKET_COUNT = 8;
+
+// Quantization: the first layer is clipped to [0, NNUE_CLIP_MAX] and the output is divided by NNUE_OUTPUT_SCALE to
+// obtain a value in centipawns.
+static constexpr int NNUE_CLIP_MAX     = 127;
+static constexpr int NNUE_OUTPUT_SCALE = 64;
+
+// Networks are stored in files that start with a header, followed by the network structure as it is laid out in memory
+// in little endian. The header is padded to a cache line, such that a memory mapped network is properly aligned.
+static constexpr uint32_t NNUE_FILE_MAGIC   = 0x4E4E4D57;  // "WMNN" in little endian.
+static constexpr uint32_t NNUE_FILE_VERSION = 1;
+
+
+// This structure contains the quantized weights and biases of the network.
+struct Network {
+    alignas(64) int16_t feature_weights[NNUE_FEATURE_COUNT][NNUE_HIDDEN_SIZE];
+    alignas(64) int16_t feature_biases[NNUE_HIDDEN_SIZE];
+    alignas(64) int8_t output_weights[NNUE_OUTPUT_BUCKET_COUNT][2 * NNUE_HIDDEN_SIZE];
+    int32_t output_biases[NNUE_OUTPUT_BUCKET_COUNT];
+};
+
+// The header of a network file. Besides the magic and version, it contains the dimensions of the network, such that a
+// network of a different architecture is rejected instead of misinterpreted.
+struct NetworkFileHeader {
+    alignas(64) uint32_t magic;
+    uint32_t version;
+    uint32_t feature_count;
+    uint32_t hidden_size;
+    uint32_t output_bucket_count;
+};
+
+static_assert(sizeof(struct NetworkFileHeader) == 64);
+
+// An entry of the refresh table contains an accumulator for a king bucket together with the pieces it was computed for.
+// Refreshing an accumulator from such an entry only requires the pieces that changed since then.
+struct RefreshEntry {
+    alignas(64) int16_t values[NNUE_HIDDEN_SIZE];
+    Bitboard pieces[PIECE_COUNT];
+};
+
+// This structure contains the thread local state of the evaluation: the network that is used and the refresh table for
+// every perspective and king bucket.
+struct Evaluator {
+    const struct Network* network;
+    struct RefreshEntry refresh_table[COLOR_COUNT][NNUE_KING_BUCKET_COUNT];
+};
+
+
+// Initializes the default network, which is derived from the piece-square tables.
+void initialize_default_network();
+
+// Returns the network that is used by new searches.
+const struct Network* current_network();
+
+// Returns the generation of the current network. Every replacement of the network starts a new generation, which is
+// never 0.
+uint64_t current_network_generation();
+
+// Makes the default network the current network. This must not be called during a search.
+void use_default_network();
+
+// Makes the network in the file at `path` the current network. The file is memory mapped, such that all engine
+// processes on a host share a single copy in the page cache. Returns false and keeps the current network if the file
+// cannot be loaded. This must not be called during a search.
+bool load_network(const char* path);
+
+// Writes the current network to the file at `path`. Returns false if the file cannot be written.
+bool save_network(const char* path);
+
+
+// Sets up `evaluator` to use `network` with an empty refresh table.
+void reset_evaluator(struct Evaluator* evaluator, const struct Network* network);
+
+// Computes the accumulators of `position` for both perspectives from scratch.
+void refresh_accumulators(struct Evaluator* evaluator, const struct Position* position);
+
+// Returns the value of `position` according to the network of `evaluator`, from the perspective of the side to move.
+Value evaluate_network(struct Evaluator* evaluator, const struct Position* position);
+
+
+
+#endif /* #ifndef WINDMOLEN_NNUE_H_ */
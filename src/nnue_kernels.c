@@ -0,0 +1,232 @@
+#include "nnue_kernels.h"
+
+#include <assert.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "accumulator.h"
+#include "util.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#    define NNUE_X86_KERNELS
+#    include <immintrin.h>
+#endif
+
+
+
+static void update_values_scalar(int16_t values[static NNUE_HIDDEN_SIZE], const int16_t (*weights)[NNUE_HIDDEN_SIZE],
+                                 const size_t* added_features, const size_t added_count,
+                                 const size_t* removed_features, const size_t removed_count) {
+    for (size_t j = 0; j < added_count; ++j)
+        for (size_t i = 0; i < NNUE_HIDDEN_SIZE; ++i)
+            values[i] += weights[added_features[j]][i];
+
+    for (size_t j = 0; j < removed_count; ++j)
+        for (size_t i = 0; i < NNUE_HIDDEN_SIZE; ++i)
+            values[i] -= weights[removed_features[j]][i];
+}
+
+static int32_t output_scalar(const int16_t us[static NNUE_HIDDEN_SIZE], const int16_t them[static NNUE_HIDDEN_SIZE],
+                             const int8_t weights[static 2 * NNUE_HIDDEN_SIZE], const int16_t clip_max) {
+    int32_t output = 0;
+    for (size_t i = 0; i < NNUE_HIDDEN_SIZE; ++i) {
+        const int32_t our_value   = (us[i] < 0) ? 0 : (us[i] > clip_max) ? clip_max : us[i];
+        const int32_t their_value = (them[i] < 0) ? 0 : (them[i] > clip_max) ? clip_max : them[i];
+
+        output += our_value * weights[i] + their_value * weights[NNUE_HIDDEN_SIZE + i];
+    }
+
+    return output;
+}
+
+
+#ifdef NNUE_X86_KERNELS
+
+// The vector kernels process the hidden layer one register at a time. For every register, all feature rows are applied
+// before it is stored again, such that the values are only loaded and stored once.
+static_assert(NNUE_HIDDEN_SIZE % 32 == 0);
+
+
+__attribute__((target("sse4.1"))) static void update_values_sse41(int16_t values[static NNUE_HIDDEN_SIZE],
+                                                                  const int16_t (*weights)[NNUE_HIDDEN_SIZE],
+                                                                  const size_t* added_features,
+                                                                  const size_t added_count,
+                                                                  const size_t* removed_features,
+                                                                  const size_t removed_count) {
+    for (size_t i = 0; i < NNUE_HIDDEN_SIZE; i += 8) {
+        __m128i vector = _mm_loadu_si128((const __m128i*)&values[i]);
+
+        for (size_t j = 0; j < added_count; ++j)
+            vector = _mm_add_epi16(vector, _mm_loadu_si128((const __m128i*)&weights[added_features[j]][i]));
+        for (size_t j = 0; j < removed_count; ++j)
+            vector = _mm_sub_epi16(vector, _mm_loadu_si128((const __m128i*)&weights[removed_features[j]][i]));
+
+        _mm_storeu_si128((__m128i*)&values[i], vector);
+    }
+}
+
+// Returns the dot product of `values` clipped to [0, clip_max] with the 8 `weights`, as 4 partial sums.
+__attribute__((target("sse4.1"))) static INLINE __m128i clipped_dot_sse41(const int16_t* values, const int8_t* weights,
+                                                                         const __m128i clip_max) {
+    const __m128i clipped = _mm_min_epi16(_mm_max_epi16(_mm_loadu_si128((const __m128i*)values), _mm_setzero_si128()),
+                                          clip_max);
+    const __m128i weights16 = _mm_cvtepi8_epi16(_mm_loadl_epi64((const __m128i*)weights));
+
+    return _mm_madd_epi16(clipped, weights16);
+}
+
+__attribute__((target("sse4.1"))) static int32_t output_sse41(const int16_t us[static NNUE_HIDDEN_SIZE],
+                                                             const int16_t them[static NNUE_HIDDEN_SIZE],
+                                                             const int8_t weights[static 2 * NNUE_HIDDEN_SIZE],
+                                                             const int16_t clip_max) {
+    const __m128i clip_max_vector = _mm_set1_epi16(clip_max);
+
+    __m128i sum = _mm_setzero_si128();
+    for (size_t i = 0; i < NNUE_HIDDEN_SIZE; i += 8) {
+        sum = _mm_add_epi32(sum, clipped_dot_sse41(&us[i], &weights[i], clip_max_vector));
+        sum = _mm_add_epi32(sum, clipped_dot_sse41(&them[i], &weights[NNUE_HIDDEN_SIZE + i], clip_max_vector));
+    }
+
+    sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, _MM_SHUFFLE(1, 0, 3, 2)));
+    sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, _MM_SHUFFLE(2, 3, 0, 1)));
+
+    return _mm_cvtsi128_si32(sum);
+}
+
+
+__attribute__((target("avx2"))) static void update_values_avx2(int16_t values[static NNUE_HIDDEN_SIZE],
+                                                               const int16_t (*weights)[NNUE_HIDDEN_SIZE],
+                                                               const size_t* added_features, const size_t added_count,
+                                                               const size_t* removed_features,
+                                                               const size_t removed_count) {
+    for (size_t i = 0; i < NNUE_HIDDEN_SIZE; i += 16) {
+        __m256i vector = _mm256_loadu_si256((const __m256i*)&values[i]);
+
+        for (size_t j = 0; j < added_count; ++j)
+            vector = _mm256_add_epi16(vector, _mm256_loadu_si256((const __m256i*)&weights[added_features[j]][i]));
+        for (size_t j = 0; j < removed_count; ++j)
+            vector = _mm256_sub_epi16(vector, _mm256_loadu_si256((const __m256i*)&weights[removed_features[j]][i]));
+
+        _mm256_storeu_si256((__m256i*)&values[i], vector);
+    }
+}
+
+// Returns the dot product of `values` clipped to [0, clip_max] with the 16 `weights`, as 8 partial sums.
+__attribute__((target("avx2"))) static INLINE __m256i clipped_dot_avx2(const int16_t* values, const int8_t* weights,
+                                                                      const __m256i clip_max) {
+    const __m256i clipped = _mm256_min_epi16(
+    _mm256_max_epi16(_mm256_loadu_si256((const __m256i*)values), _mm256_setzero_si256()), clip_max);
+    const __m256i weights16 = _mm256_cvtepi8_epi16(_mm_loadu_si128((const __m128i*)weights));
+
+    return _mm256_madd_epi16(clipped, weights16);
+}
+
+__attribute__((target("avx2"))) static int32_t output_avx2(const int16_t us[static NNUE_HIDDEN_SIZE],
+                                                          const int16_t them[static NNUE_HIDDEN_SIZE],
+                                                          const int8_t weights[static 2 * NNUE_HIDDEN_SIZE],
+                                                          const int16_t clip_max) {
+    const __m256i clip_max_vector = _mm256_set1_epi16(clip_max);
+
+    __m256i sum = _mm256_setzero_si256();
+    for (size_t i = 0; i < NNUE_HIDDEN_SIZE; i += 16) {
+        sum = _mm256_add_epi32(sum, clipped_dot_avx2(&us[i], &weights[i], clip_max_vector));
+        sum = _mm256_add_epi32(sum, clipped_dot_avx2(&them[i], &weights[NNUE_HIDDEN_SIZE + i], clip_max_vector));
+    }
+
+    __m128i sum128 = _mm_add_epi32(_mm256_castsi256_si128(sum), _mm256_extracti128_si256(sum, 1));
+    sum128         = _mm_add_epi32(sum128, _mm_shuffle_epi32(sum128, _MM_SHUFFLE(1, 0, 3, 2)));
+    sum128         = _mm_add_epi32(sum128, _mm_shuffle_epi32(sum128, _MM_SHUFFLE(2, 3, 0, 1)));
+
+    return _mm_cvtsi128_si32(sum128);
+}
+
+
+__attribute__((target("avx512f,avx512bw"))) static void update_values_avx512(
+int16_t values[static NNUE_HIDDEN_SIZE], const int16_t (*weights)[NNUE_HIDDEN_SIZE], const size_t* added_features,
+const size_t added_count, const size_t* removed_features, const size_t removed_count) {
+    for (size_t i = 0; i < NNUE_HIDDEN_SIZE; i += 32) {
+        __m512i vector = _mm512_loadu_si512(&values[i]);
+
+        for (size_t j = 0; j < added_count; ++j)
+            vector = _mm512_add_epi16(vector, _mm512_loadu_si512(&weights[added_features[j]][i]));
+        for (size_t j = 0; j < removed_count; ++j)
+            vector = _mm512_sub_epi16(vector, _mm512_loadu_si512(&weights[removed_features[j]][i]));
+
+        _mm512_storeu_si512(&values[i], vector);
+    }
+}
+
+// Returns `values` clipped to [0, clip_max] and the 32 `weights` widened to 16 bits.
+__attribute__((target("avx512f,avx512bw"))) static INLINE void clip_and_widen_avx512(const int16_t* values,
+                                                                                    const int8_t* weights,
+                                                                                    const __m512i clip_max,
+                                                                                    __m512i* clipped,
+                                                                                    __m512i* weights16) {
+    *clipped   = _mm512_min_epi16(_mm512_max_epi16(_mm512_loadu_si512(values), _mm512_setzero_si512()), clip_max);
+    *weights16 = _mm512_cvtepi8_epi16(_mm256_loadu_si256((const __m256i*)weights));
+}
+
+__attribute__((target("avx512f,avx512bw"))) static int32_t output_avx512(
+const int16_t us[static NNUE_HIDDEN_SIZE], const int16_t them[static NNUE_HIDDEN_SIZE],
+const int8_t weights[static 2 * NNUE_HIDDEN_SIZE], const int16_t clip_max) {
+    const __m512i clip_max_vector = _mm512_set1_epi16(clip_max);
+
+    __m512i sum = _mm512_setzero_si512();
+    __m512i clipped;
+    __m512i weights16;
+    for (size_t i = 0; i < NNUE_HIDDEN_SIZE; i += 32) {
+        clip_and_widen_avx512(&us[i], &weights[i], clip_max_vector, &clipped, &weights16);
+        sum = _mm512_add_epi32(sum, _mm512_madd_epi16(clipped, weights16));
+
+        clip_and_widen_avx512(&them[i], &weights[NNUE_HIDDEN_SIZE + i], clip_max_vector, &clipped, &weights16);
+        sum = _mm512_add_epi32(sum, _mm512_madd_epi16(clipped, weights16));
+    }
+
+    return _mm512_reduce_add_epi32(sum);
+}
+
+// VNNI fuses the multiplication and the accumulation of the 16-bit products into a single instruction.
+__attribute__((target("avx512f,avx512bw,avx512vnni"))) static int32_t output_avx512_vnni(
+const int16_t us[static NNUE_HIDDEN_SIZE], const int16_t them[static NNUE_HIDDEN_SIZE],
+const int8_t weights[static 2 * NNUE_HIDDEN_SIZE], const int16_t clip_max) {
+    const __m512i clip_max_vector = _mm512_set1_epi16(clip_max);
+
+    __m512i sum = _mm512_setzero_si512();
+    __m512i clipped;
+    __m512i weights16;
+    for (size_t i = 0; i < NNUE_HIDDEN_SIZE; i += 32) {
+        clip_and_widen_avx512(&us[i], &weights[i], clip_max_vector, &clipped, &weights16);
+        sum = _mm512_dpwssd_epi32(sum, clipped, weights16);
+
+        clip_and_widen_avx512(&them[i], &weights[NNUE_HIDDEN_SIZE + i], clip_max_vector, &clipped, &weights16);
+        sum = _mm512_dpwssd_epi32(sum, clipped, weights16);
+    }
+
+    return _mm512_reduce_add_epi32(sum);
+}
+
+#endif /* #ifdef NNUE_X86_KERNELS */
+
+
+struct NnueKernels nnue_kernels = {
+    .name          = "scalar",
+    .update_values = update_values_scalar,
+    .output        = output_scalar,
+};
+
+
+void select_nnue_kernels() {
+#ifdef NNUE_X86_KERNELS
+    __builtin_cpu_init();
+
+    if (__builtin_cpu_supports("avx512bw") && __builtin_cpu_supports("avx512vnni")) {
+        nnue_kernels = (struct NnueKernels){"avx512-vnni", update_values_avx512, output_avx512_vnni};
+    } else if (__builtin_cpu_supports("avx512bw")) {
+        nnue_kernels = (struct NnueKernels){"avx512", update_values_avx512, output_avx512};
+    } else if (__builtin_cpu_supports("avx2")) {
+        nnue_kernels = (struct NnueKernels){"avx2", update_values_avx2, output_avx2};
+    } else if (__builtin_cpu_supports("sse4.1")) {
+        nnue_kernels = (struct NnueKernels){"sse4.1", update_values_sse41, output_sse41};
+    }
+#endif /* #ifdef NNUE_X86_KERNELS */
+}
@@ -0,0 +1,39 @@
+#ifndef WINDMOLEN_NNUE_KERNELS_H_
+#define WINDMOLEN_NNUE_KERNELS_H_
+
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "accumulator.h"
+
+
+
+// Adds the rows of `weights` of the `added_count` features in `added_features` to `values`, and subtracts the rows of
+// the `removed_count` features in `removed_features`.
+typedef void (*UpdateValuesKernel)(int16_t values[static NNUE_HIDDEN_SIZE],
+                                   const int16_t (*weights)[NNUE_HIDDEN_SIZE], const size_t* added_features,
+                                   size_t added_count, const size_t* removed_features, size_t removed_count);
+
+// Returns the dot product of `us` and `them`, both clipped to [0, clip_max], with the first and second half of
+// `weights` respectively.
+typedef int32_t (*OutputKernel)(const int16_t us[static NNUE_HIDDEN_SIZE], const int16_t them[static NNUE_HIDDEN_SIZE],
+                                const int8_t weights[static 2 * NNUE_HIDDEN_SIZE], int16_t clip_max);
+
+// This structure contains the kernels used for network inference, which depend on the instruction set of the CPU.
+struct NnueKernels {
+    // The name of the instruction set of the kernels, which is reported after the uci command.
+    const char* name;
+    UpdateValuesKernel update_values;
+    OutputKernel output;
+};
+
+extern struct NnueKernels nnue_kernels;
+
+
+// Selects the fastest kernels the CPU supports. This must be called once at startup, before any evaluation.
+void select_nnue_kernels();
+
+
+
+#endif /* #ifndef WINDMOLEN_NNUE_KERNELS_H_ */
@@ -1,14 +1,25 @@
 #include "options.h"
 
 #include <assert.h>
+#include <string.h>
 
 
 
 void initialize_options(struct Options* options) {
     assert(options != nullptr);
 
-    options->thread_count  = OPTION_THREAD_COUNT_DEFAULT;
-    options->hash_size     = OPTION_HASH_SIZE_DEFAULT;
-    options->move_overhead = OPTION_MOVE_OVERHEAD_DEFAULT;
-    options->ponder_mode   = OPTION_PONDER_MODE_DEFAULT;
+    options->thread_count       = OPTION_THREAD_COUNT_DEFAULT;
+    options->hash_size          = OPTION_HASH_SIZE_DEFAULT;
+    options->move_overhead      = OPTION_MOVE_OVERHEAD_DEFAULT;
+    options->nodes_time         = OPTION_NODES_TIME_DEFAULT;
+    options->ponder_mode        = OPTION_PONDER_MODE_DEFAULT;
+    options->multi_pv           = OPTION_MULTI_PV_DEFAULT;
+    options->split_root_moves   = OPTION_SPLIT_ROOT_MOVES_DEFAULT;
+    options->syzygy_probe_depth = OPTION_SYZYGY_PROBE_DEPTH_DEFAULT;
+    options->syzygy_probe_limit = OPTION_SYZYGY_PROBE_LIMIT_DEFAULT;
+    options->perft_split_depth  = OPTION_PERFT_SPLIT_DEPTH_DEFAULT;
+    options->perft_hash_size    = OPTION_PERFT_HASH_SIZE_DEFAULT;
+    options->debug_mode         = false;
+    strcpy(options->eval_file, OPTION_EVAL_FILE_DEFAULT);
+    strcpy(options->syzygy_path, OPTION_SYZYGY_PATH_DEFAULT);
 }
@@ -4,6 +4,8 @@
 #include <stddef.h>
 #include <stdint.h>
 
+#include "constants.h"
+
 
 
 enum OptionType {
@@ -42,13 +44,78 @@ static constexpr uint64_t OPTION_MOVE_OVERHEAD_DEFAULT     = 10;  // 10 ms.
 static constexpr uint64_t OPTION_MOVE_OVERHEAD_MIN         = 0;
 static constexpr uint64_t OPTION_MOVE_OVERHEAD_MAX         = 5000;  // 5 s.
 
+static constexpr const char OPTION_NODES_TIME_NAME[]    = "nodestime";
+static constexpr enum OptionType OPTION_NODES_TIME_TYPE = OPTION_TYPE_SPIN;
+static constexpr uint64_t OPTION_NODES_TIME_DEFAULT     = 0;  // Nodes per ms, 0 disables it.
+static constexpr uint64_t OPTION_NODES_TIME_MIN         = 0;
+static constexpr uint64_t OPTION_NODES_TIME_MAX         = 10000;
+
+static constexpr const char OPTION_MULTI_PV_NAME[]    = "MultiPV";
+static constexpr enum OptionType OPTION_MULTI_PV_TYPE = OPTION_TYPE_SPIN;
+static constexpr size_t OPTION_MULTI_PV_DEFAULT       = 1;
+static constexpr size_t OPTION_MULTI_PV_MIN           = 1;
+static constexpr size_t OPTION_MULTI_PV_MAX           = MAX_MOVES;
+
+static constexpr const char OPTION_SPLIT_ROOT_MOVES_NAME[]    = "Split Root Moves";
+static constexpr enum OptionType OPTION_SPLIT_ROOT_MOVES_TYPE = OPTION_TYPE_CHECK;
+static constexpr bool OPTION_SPLIT_ROOT_MOVES_DEFAULT         = false;
+
+static constexpr const char OPTION_EVAL_FILE_NAME[]    = "EvalFile";
+static constexpr enum OptionType OPTION_EVAL_FILE_TYPE = OPTION_TYPE_STRING;
+static constexpr const char OPTION_EVAL_FILE_DEFAULT[] = "<default>";  // The built in network.
+static constexpr size_t OPTION_EVAL_FILE_MAX_LENGTH    = 4096;
+
+static constexpr const char OPTION_SYZYGY_PATH_NAME[]    = "SyzygyPath";
+static constexpr enum OptionType OPTION_SYZYGY_PATH_TYPE = OPTION_TYPE_STRING;
+static constexpr const char OPTION_SYZYGY_PATH_DEFAULT[] = "<empty>";  // No tablebases.
+static constexpr size_t OPTION_SYZYGY_PATH_MAX_LENGTH    = 4096;
+
+static constexpr const char OPTION_SYZYGY_PROBE_DEPTH_NAME[]    = "SyzygyProbeDepth";
+static constexpr enum OptionType OPTION_SYZYGY_PROBE_DEPTH_TYPE = OPTION_TYPE_SPIN;
+static constexpr size_t OPTION_SYZYGY_PROBE_DEPTH_DEFAULT       = 1;
+static constexpr size_t OPTION_SYZYGY_PROBE_DEPTH_MIN           = 1;
+static constexpr size_t OPTION_SYZYGY_PROBE_DEPTH_MAX           = 100;
+
+static constexpr const char OPTION_SYZYGY_PROBE_LIMIT_NAME[]    = "SyzygyProbeLimit";
+static constexpr enum OptionType OPTION_SYZYGY_PROBE_LIMIT_TYPE = OPTION_TYPE_SPIN;
+static constexpr size_t OPTION_SYZYGY_PROBE_LIMIT_DEFAULT       = 7;
+static constexpr size_t OPTION_SYZYGY_PROBE_LIMIT_MIN           = 0;
+static constexpr size_t OPTION_SYZYGY_PROBE_LIMIT_MAX           = 7;
+
+// Perft is split into the subtrees at this many plies from the root, which are divided over the threads.
+static constexpr const char OPTION_PERFT_SPLIT_DEPTH_NAME[]    = "Perft Split Depth";
+static constexpr enum OptionType OPTION_PERFT_SPLIT_DEPTH_TYPE = OPTION_TYPE_SPIN;
+static constexpr size_t OPTION_PERFT_SPLIT_DEPTH_DEFAULT       = 2;
+static constexpr size_t OPTION_PERFT_SPLIT_DEPTH_MIN           = 1;
+static constexpr size_t OPTION_PERFT_SPLIT_DEPTH_MAX           = 3;
+
+// The size of the perft table in MB, 0 disables it.
+static constexpr const char OPTION_PERFT_HASH_SIZE_NAME[]    = "Perft Hash";
+static constexpr enum OptionType OPTION_PERFT_HASH_SIZE_TYPE = OPTION_TYPE_SPIN;
+static constexpr uint64_t OPTION_PERFT_HASH_SIZE_DEFAULT     = 0;
+static constexpr uint64_t OPTION_PERFT_HASH_SIZE_MIN         = 0;
+static constexpr uint64_t OPTION_PERFT_HASH_SIZE_MAX         = 1 << 20;
+
 
 // This structure contains the values of the various options that are supported and can be changed by the UCI protocol.
 struct Options {
     size_t thread_count;
     uint64_t hash_size;
     uint64_t move_overhead;
+    uint64_t nodes_time;
     bool ponder_mode;
+    size_t multi_pv;
+    bool split_root_moves;
+    char eval_file[OPTION_EVAL_FILE_MAX_LENGTH];
+    char syzygy_path[OPTION_SYZYGY_PATH_MAX_LENGTH];
+    size_t syzygy_probe_depth;
+    size_t syzygy_probe_limit;
+    size_t perft_split_depth;
+    uint64_t perft_hash_size;
+
+    // Set by the UCI debug command rather than by an option. In debug mode, the search statistics are printed after
+    // every iteration if they are compiled in.
+    bool debug_mode;
 };
 
 
@@ -0,0 +1,213 @@
+#include "pawns.h"
+
+#include <assert.h>
+#include <stddef.h>
+
+#include "bitboard.h"
+#include "board.h"
+#include "piece.h"
+#include "position.h"
+#include "score.h"
+#include "util.h"
+
+
+
+static constexpr PackedScore DOUBLED_PAWN        = PACKED_SCORE(-10, -25);
+static constexpr PackedScore ISOLATED_PAWN       = PACKED_SCORE(-10, -15);
+static constexpr PackedScore BACKWARD_PAWN       = PACKED_SCORE(-8, -12);
+static constexpr PackedScore BLOCKED_PASSED_PAWN = PACKED_SCORE(0, -10);
+
+// Indexed by the rank of the passed pawn relative to its color.
+static const PackedScore passed_pawn[RANK_COUNT] = {
+    PACKED_SCORE(0, 0),   PACKED_SCORE(5, 10),  PACKED_SCORE(10, 15), PACKED_SCORE(15, 25),
+    PACKED_SCORE(30, 45), PACKED_SCORE(50, 75), PACKED_SCORE(80, 120), PACKED_SCORE(0, 0),
+};
+
+// Indexed by the distance of the closest own pawn in front of the king on a shelter file, where 0 means there is none
+// close enough. The shelter only matters in the middle game.
+static constexpr size_t SHELTER_DISTANCE_COUNT = 4;
+static const PackedScore shelter[SHELTER_DISTANCE_COUNT] = {
+    PACKED_SCORE(-25, 0), PACKED_SCORE(0, 0), PACKED_SCORE(-10, 0), PACKED_SCORE(-18, 0),
+};
+
+
+// Returns `bitboard` together with all squares in front of it from the perspective of `color`.
+static INLINE Bitboard fill_forward(const enum Color color, Bitboard bitboard) {
+    assert(is_valid_color(color));
+
+    if (color == COLOR_WHITE) {
+        bitboard |= bitboard << 8;
+        bitboard |= bitboard << 16;
+        bitboard |= bitboard << 32;
+    } else {
+        bitboard |= bitboard >> 8;
+        bitboard |= bitboard >> 16;
+        bitboard |= bitboard >> 32;
+    }
+
+    return bitboard;
+}
+
+// Returns `bitboard` shifted one rank forward from the perspective of `color`.
+static INLINE Bitboard shift_forward(const enum Color color, const Bitboard bitboard) {
+    assert(is_valid_color(color));
+
+    return (color == COLOR_WHITE) ? shift_bitboard_north(bitboard) : shift_bitboard_south(bitboard);
+}
+
+// Returns the squares on the files adjacent to the squares of `bitboard`.
+static INLINE Bitboard adjacent_files(const Bitboard bitboard) {
+    return shift_bitboard_east(bitboard) | shift_bitboard_west(bitboard);
+}
+
+// Returns the rank of `square` from the perspective of `color`.
+static INLINE enum Rank relative_rank(const enum Color color, const enum Square square) {
+    assert(is_valid_color(color));
+    assert(is_valid_square(square));
+
+    return (color == COLOR_WHITE) ? rank_of_square(square) : (enum Rank)(RANK_8 - rank_of_square(square));
+}
+
+
+// Computes the pawn structure of `color` in `position` and stores it in `entry`.
+static void compute_pawn_structure(struct PawnEntry* entry, const struct Position* position, const enum Color color) {
+    assert(entry != nullptr);
+    assert(position != nullptr);
+    assert(is_valid_color(color));
+
+    const enum Color opponent  = opposite_color(color);
+    const Bitboard our_pawns   = piece_occupancy(position, color, PIECE_TYPE_PAWN);
+    const Bitboard their_pawns = piece_occupancy(position, opponent, PIECE_TYPE_PAWN);
+
+    PackedScore score     = 0;
+    Bitboard passed_pawns = EMPTY_BITBOARD;
+
+    Bitboard pawns = our_pawns;
+    while (pawns != EMPTY_BITBOARD) {
+        const enum Square square = (enum Square)pop_lsb64(&pawns);
+        const Bitboard bitboard  = square_bitboard(square);
+
+        const Bitboard front_span      = fill_forward(color, shift_forward(color, bitboard));
+        const Bitboard file_and_behind = fill_forward(opponent, bitboard);
+        const Bitboard stop_square     = shift_forward(color, bitboard);
+
+        const bool doubled  = (front_span & our_pawns) != EMPTY_BITBOARD;
+        const bool isolated = (adjacent_files(file_bitboard_from_square(square)) & our_pawns) == EMPTY_BITBOARD;
+        const bool passed   = !doubled && ((front_span | adjacent_files(front_span)) & their_pawns) == EMPTY_BITBOARD;
+
+        // A backward pawn cannot be supported by the pawns on its adjacent files and cannot safely advance.
+        const bool backward = !isolated && (adjacent_files(file_and_behind) & our_pawns) == EMPTY_BITBOARD
+                           && (stop_square & entry->pawn_attacks[opponent]) != EMPTY_BITBOARD;
+
+        if (doubled)
+            score += DOUBLED_PAWN;
+
+        if (isolated)
+            score += ISOLATED_PAWN;
+        else if (backward)
+            score += BACKWARD_PAWN;
+
+        if (passed) {
+            passed_pawns |= bitboard;
+            score += passed_pawn[relative_rank(color, square)];
+        }
+    }
+
+    entry->passed_pawns[color] = passed_pawns;
+    entry->score[color]        = score;
+}
+
+// Returns the score of the pawns in front of the king of `color` in `position`. On the file of the king and
+// both adjacent files, the closest own pawn in front of the king should be no more than a few ranks away.
+static PackedScore compute_shelter(const struct Position* position, const enum Color color) {
+    assert(position != nullptr);
+    assert(is_valid_color(color));
+
+    const enum Square king       = king_square(position, color);
+    const Bitboard in_front      = fill_forward(color, shift_forward(color, rank_bitboard_from_square(king)));
+    const Bitboard shelter_pawns = piece_occupancy(position, color, PIECE_TYPE_PAWN) & in_front;
+
+    PackedScore score = 0;
+
+    Bitboard files = file_bitboard_from_square(king) | adjacent_files(file_bitboard_from_square(king));
+    while (files != EMPTY_BITBOARD) {
+        const enum File file = file_of_square((enum Square)lsb64(files));
+        files &= ~file_bitboard(file);
+
+        size_t closest_distance = 0;  // No pawn at all.
+
+        Bitboard file_pawns = shelter_pawns & file_bitboard(file);
+        while (file_pawns != EMPTY_BITBOARD) {
+            const size_t pawn_distance = rank_distance((enum Square)pop_lsb64(&file_pawns), king);
+            if (closest_distance == 0 || pawn_distance < closest_distance)
+                closest_distance = pawn_distance;
+        }
+
+        score += shelter[(closest_distance < SHELTER_DISTANCE_COUNT) ? closest_distance : 0];
+    }
+
+    return score;
+}
+
+
+void clear_pawn_table(struct PawnTable* pawn_table) {
+    assert(pawn_table != nullptr);
+
+    // A position without pawns has a pawn key of 0, so an empty entry must not match any pawn key by accident.
+    for (size_t i = 0; i < PAWN_TABLE_SIZE; ++i)
+        pawn_table->entries[i].key = ~(ZobristKey)0;
+}
+
+const struct PawnEntry* probe_pawn_table(struct PawnTable* pawn_table, const struct Position* position) {
+    assert(pawn_table != nullptr);
+    assert(position != nullptr);
+
+    const ZobristKey key    = pawn_key(position);
+    struct PawnEntry* entry = &pawn_table->entries[key & (PAWN_TABLE_SIZE - 1)];
+
+    if (entry->key != key) {
+        entry->key = key;
+
+        // The backward pawns of both colors depend on the pawn attacks of the opponent.
+        const Bitboard white_pawns = piece_occupancy(position, COLOR_WHITE, PIECE_TYPE_PAWN);
+        const Bitboard black_pawns = piece_occupancy(position, COLOR_BLACK, PIECE_TYPE_PAWN);
+
+        entry->pawn_attacks[COLOR_WHITE] = shift_bitboard_northeast(white_pawns)
+                                         | shift_bitboard_northwest(white_pawns);
+        entry->pawn_attacks[COLOR_BLACK] = shift_bitboard_southeast(black_pawns)
+                                         | shift_bitboard_southwest(black_pawns);
+
+        compute_pawn_structure(entry, position, COLOR_WHITE);
+        compute_pawn_structure(entry, position, COLOR_BLACK);
+
+        entry->king_squares[COLOR_WHITE] = SQUARE_NONE;
+        entry->king_squares[COLOR_BLACK] = SQUARE_NONE;
+    }
+
+    for (enum Color color = COLOR_WHITE; color < COLOR_COUNT; ++color) {
+        if (entry->king_squares[color] != king_square(position, color)) {
+            entry->king_squares[color]  = king_square(position, color);
+            entry->shelter_score[color] = compute_shelter(position, color);
+        }
+    }
+
+    return entry;
+}
+
+PackedScore evaluate_pawns(struct PawnTable* pawn_table, const struct Position* position) {
+    assert(pawn_table != nullptr);
+    assert(position != nullptr);
+
+    const struct PawnEntry* entry = probe_pawn_table(pawn_table, position);
+
+    PackedScore score = entry->score[COLOR_WHITE] - entry->score[COLOR_BLACK] + entry->shelter_score[COLOR_WHITE]
+                      - entry->shelter_score[COLOR_BLACK];
+
+    // Passed pawns that are blocked by a piece are worth less. This depends on the other pieces, so it is not cached.
+    const Bitboard occupancy = position->total_occupancy;
+    score += BLOCKED_PASSED_PAWN
+           * (popcount64(shift_bitboard_north(entry->passed_pawns[COLOR_WHITE]) & occupancy)
+              - popcount64(shift_bitboard_south(entry->passed_pawns[COLOR_BLACK]) & occupancy));
+
+    return (position->side_to_move == COLOR_WHITE) ? score : -score;
+}
@@ -0,0 +1,53 @@
+#ifndef WINDMOLEN_PAWNS_H_
+#define WINDMOLEN_PAWNS_H_
+
+
+#include <stddef.h>
+
+#include "bitboard.h"
+#include "board.h"
+#include "piece.h"
+#include "position.h"
+#include "score.h"
+#include "zobrist.h"
+
+
+
+// The number of entries in a pawn table, which must be a power of two. Pawn structures change rarely during a search,
+// so a small table already has a very high hit rate.
+static constexpr size_t PAWN_TABLE_SIZE = 1 << 13;
+static_assert((PAWN_TABLE_SIZE & (PAWN_TABLE_SIZE - 1)) == 0);
+
+// An entry of the pawn table contains everything about a pawn structure that does not depend on the other pieces.
+struct PawnEntry {
+    ZobristKey key;
+
+    Bitboard passed_pawns[COLOR_COUNT];
+    Bitboard pawn_attacks[COLOR_COUNT];
+
+    // The scores of the doubled, isolated, backward and passed pawns of every color.
+    PackedScore score[COLOR_COUNT];
+
+    // The pawn shelter also depends on the king square, so we store the king squares it was last computed for.
+    enum Square king_squares[COLOR_COUNT];
+    PackedScore shelter_score[COLOR_COUNT];
+};
+
+// The pawn table is a thread local hash table of pawn entries, indexed by the pawn key of a position.
+struct PawnTable {
+    struct PawnEntry entries[PAWN_TABLE_SIZE];
+};
+
+
+// Removes all entries from `pawn_table`.
+void clear_pawn_table(struct PawnTable* pawn_table);
+
+// Returns the entry of the pawn structure of `position`, which is computed if it is not in `pawn_table` yet.
+const struct PawnEntry* probe_pawn_table(struct PawnTable* pawn_table, const struct Position* position);
+
+// Returns the score of the pawn structure and the pawn shelters of `position` from the perspective of the side to move.
+PackedScore evaluate_pawns(struct PawnTable* pawn_table, const struct Position* position);
+
+
+
+#endif /* #ifndef WINDMOLEN_PAWNS_H_ */
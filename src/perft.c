@@ -0,0 +1,981 @@
+#include "perft.h"
+
+#include <assert.h>
+#include <ctype.h>
+#include <inttypes.h>
+#include <stdatomic.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "constants.h"
+#include "move.h"
+#include "move_generation.h"
+#include "options.h"
+#include "position.h"
+#include "thread.h"
+#include "time_manager.h"
+#include "uci.h"
+#include "util.h"
+
+
+
+// The perft table memoizes the number of nodes of a position at a depth, and for extended perft also the extra
+// information. It is shared by all threads without locks. An entry consists of a check word followed by its data
+// words, and the check word is the key xor'ed with all data words. An entry that is torn by two threads writing it at
+// the same time then no longer matches its key, so it is never used.
+struct PerftTable {
+    _Atomic(uint64_t)* words;
+    size_t entry_count;  // A power of two.
+    size_t entry_words;  // The check word, the number of nodes and, for extended perft, the extra information.
+    uint64_t size;       // In MB.
+};
+
+static_assert(sizeof(size_t) == sizeof(uint64_t));
+static constexpr size_t EXTENDED_PERFT_WORDS = sizeof(struct ExtendedPerft) / sizeof(uint64_t);
+
+static struct PerftTable perft_table = {.words = nullptr, .entry_count = 0, .entry_words = 0, .size = 0};
+
+
+// Adds the extra information of `other` to `ext_perft`.
+static void add_extended_perft(struct ExtendedPerft* ext_perft, const struct ExtendedPerft* other) {
+    assert(ext_perft != nullptr);
+    assert(other != nullptr);
+
+    ext_perft->captures += other->captures;
+    ext_perft->en_passants += other->en_passants;
+    ext_perft->castles += other->castles;
+    ext_perft->promotions += other->promotions;
+    ext_perft->direct_checks += other->direct_checks;
+    ext_perft->single_discovered_checks += other->single_discovered_checks;
+    ext_perft->direct_discovered_checks += other->direct_discovered_checks;
+    ext_perft->double_discovered_checks += other->double_discovered_checks;
+    ext_perft->direct_mates += other->direct_mates;
+    ext_perft->single_discovered_mates += other->single_discovered_mates;
+    ext_perft->direct_discovered_mates += other->direct_discovered_mates;
+    ext_perft->double_discovered_mates += other->double_discovered_mates;
+}
+
+// Returns the perft table with a size of `size` MB, with room for extended perft entries if `extended` is set, or a
+// null pointer if `size` is 0 or the table could not be allocated. The entries are kept as long as the size and kind of
+// the table do not change.
+static struct PerftTable* prepare_perft_table(const uint64_t size, const bool extended) {
+    const size_t entry_words = 2 + (extended ? EXTENDED_PERFT_WORDS : 0);
+
+    if (size != perft_table.size || entry_words != perft_table.entry_words) {
+        free_perft_table();
+
+        if (size == 0)
+            return nullptr;
+
+        // The number of entries is rounded down to a power of two, such that a key can be masked into an index.
+        const uint64_t max_entry_count = (size << 20) / (entry_words * sizeof(*perft_table.words));
+        size_t entry_count             = 1;
+        while (2 * entry_count <= max_entry_count)
+            entry_count *= 2;
+
+        perft_table.words = calloc(entry_count * entry_words, sizeof(*perft_table.words));
+        if (perft_table.words == nullptr) {
+            printf("info string could not allocate a perft table of %" PRIu64 " MB, running without it\n", size);
+            return nullptr;
+        }
+
+        perft_table.entry_count = entry_count;
+        perft_table.entry_words = entry_words;
+        perft_table.size        = size;
+    }
+
+    return (perft_table.size == 0) ? nullptr : &perft_table;
+}
+
+// Returns the key of `position` at `depth` in the perft table. The depth is mixed into the key, such that the results
+// of a position at different depths end up in different entries.
+static INLINE ZobristKey perft_table_key(const struct Position* position, const size_t depth) {
+    assert(position != nullptr);
+
+    return zobrist_key(position) ^ (depth * 0x9E3779B97F4A7C15ULL);
+}
+
+// Looks up `key` in `table`. If it is found, the number of nodes is stored in `nodes`, the extra information is added
+// to `ext_perft` if it is not a null pointer, and `true` is returned.
+static bool probe_perft_table(const struct PerftTable* table, const ZobristKey key, size_t* nodes,
+                              struct ExtendedPerft* ext_perft) {
+    assert(table != nullptr);
+    assert(nodes != nullptr);
+
+    _Atomic(uint64_t)* entry = &table->words[(key & (table->entry_count - 1)) * table->entry_words];
+
+    uint64_t data[1 + EXTENDED_PERFT_WORDS];
+    uint64_t check = atomic_load_explicit(&entry[0], memory_order_relaxed);
+    for (size_t i = 0; i < table->entry_words - 1; ++i) {
+        data[i] = atomic_load_explicit(&entry[i + 1], memory_order_relaxed);
+        check ^= data[i];
+    }
+
+    if (check != key)
+        return false;
+
+    *nodes = data[0];
+    if (ext_perft != nullptr) {
+        struct ExtendedPerft stored;
+        memcpy(&stored, &data[1], sizeof(stored));
+        add_extended_perft(ext_perft, &stored);
+    }
+
+    return true;
+}
+
+// Stores `nodes` and, if it is not a null pointer, `ext_perft` under `key` in `table`, replacing the previous entry.
+static void store_perft_table(struct PerftTable* table, const ZobristKey key, const size_t nodes,
+                              const struct ExtendedPerft* ext_perft) {
+    assert(table != nullptr);
+
+    _Atomic(uint64_t)* entry = &table->words[(key & (table->entry_count - 1)) * table->entry_words];
+
+    uint64_t data[1 + EXTENDED_PERFT_WORDS];
+    data[0] = nodes;
+    if (ext_perft != nullptr)
+        memcpy(&data[1], ext_perft, sizeof(*ext_perft));
+
+    uint64_t check = key;
+    for (size_t i = 0; i < table->entry_words - 1; ++i) {
+        atomic_store_explicit(&entry[i + 1], data[i], memory_order_relaxed);
+        check ^= data[i];
+    }
+    atomic_store_explicit(&entry[0], check, memory_order_relaxed);
+}
+
+
+// Computes the number of leaf nodes in the chess search tree at nonzero `depth` in `position`. Results are looked up in
+// and stored in `table`, unless it is a null pointer.
+static size_t perft_nonzero_depth(struct Position* position, const size_t depth, struct PerftTable* table) {
+    assert(position != nullptr);
+    assert(depth > 0);
+
+    // Leaves are counted by move generation, which is cheaper than a lookup.
+    const bool use_table = table != nullptr && depth > 1;
+    const ZobristKey key = use_table ? perft_table_key(position, depth) : 0;
+
+    size_t nodes;
+    if (use_table && probe_perft_table(table, key, &nodes, nullptr))
+        return nodes;
+
+    // Leaves only need the number of moves, which is counted without generating them.
+    if (depth == 1)
+        return count_legal_moves(position);
+
+    Move movelist[MAX_MOVES];
+    const size_t move_count = generate_legal_moves(position, movelist);
+
+    nodes = 0;
+    struct PositionInfo position_info;
+    for (size_t i = 0; i < move_count; ++i) {
+        do_move(position, &position_info, movelist[i]);
+        nodes += perft_nonzero_depth(position, depth - 1, table);
+        undo_move(position, movelist[i]);
+    }
+
+    if (use_table)
+        store_perft_table(table, key, nodes, nullptr);
+
+    return nodes;
+}
+
+// Same as perft_nonzero_depth(), except it adds extra information to `ext_perft`.
+static size_t extended_perft_nonzero_depth(struct Position* position, size_t depth, struct ExtendedPerft* ext_perft,
+                                           struct PerftTable* table) {
+    assert(position != nullptr);
+    assert(ext_perft != nullptr);
+    assert(depth > 0);
+
+    // The extra information of a subtree is collected separately, such that it can be stored in the table.
+    const bool use_table = table != nullptr && depth > 1;
+    const ZobristKey key = use_table ? perft_table_key(position, depth) : 0;
+
+    size_t nodes;
+    if (use_table && probe_perft_table(table, key, &nodes, ext_perft))
+        return nodes;
+
+    struct ExtendedPerft subtree;
+    struct ExtendedPerft* counters = ext_perft;
+    if (use_table) {
+        memset(&subtree, 0, sizeof(subtree));
+        counters = &subtree;
+    }
+
+    Move movelist[MAX_MOVES];
+    const size_t move_count = generate_legal_moves(position, movelist);
+
+    if (depth == 1) {
+        for (size_t i = 0; i < move_count; ++i) {
+            const enum Square destination = move_destination(movelist[i]);
+            const enum MoveType move_type = type_of_move(movelist[i]);
+
+            // We do not test for en passant here as that will be done later.
+            if (piece_on_square(position, destination) != PIECE_NONE)
+                ++ext_perft->captures;
+
+            // These three cases are mutually exclusive.
+            if (move_type == MOVE_TYPE_EN_PASSANT) {
+                // An en passant move is always a capture.
+                ++ext_perft->captures;
+                ++ext_perft->en_passants;
+            } else if (move_type == MOVE_TYPE_CASTLE) {
+                ++ext_perft->castles;
+            } else if (move_type == MOVE_TYPE_PROMOTION) {
+                ++ext_perft->promotions;
+            }
+
+
+            const bool direct_check     = gives_direct_check(position, movelist[i]);
+            const bool discovered_check = gives_discovered_check(position, movelist[i]);
+
+            // We only look for checkmate if the move is check. This saves computation time as we do not need to
+            // generate all legal moves all the time.
+            if (direct_check | discovered_check) {
+                Move temp_movelist[MAX_MOVES];
+                struct PositionInfo position_info;
+                do_move(position, &position_info, movelist[i]);
+                const size_t temp_move_count = generate_legal_moves(position, temp_movelist);
+
+                const Bitboard checkers = position->info->checkers;  // We still need this for double discovered checks.
+                undo_move(position, movelist[i]);
+
+                // Checks, else mates.
+                if (temp_move_count != 0) {
+                    if (direct_check && discovered_check) {
+                        ++ext_perft->direct_discovered_checks;
+                    } else if (direct_check) {
+                        ++ext_perft->direct_checks;
+                    } else if (!popcount64_greater_than_one(checkers)) {
+                        // If we do not have a direct check, and there is only one checker, we must have a single
+                        // discovered check, else a double discovered check.
+                        ++ext_perft->single_discovered_checks;
+                    } else {
+                        ++ext_perft->double_discovered_checks;
+                    }
+                } else {
+                    // Same as above but with mate variants.
+                    if (direct_check && discovered_check) {
+                        ++ext_perft->direct_discovered_mates;
+                    } else if (direct_check) {
+                        ++ext_perft->direct_mates;
+                    } else if (!popcount64_greater_than_one(checkers)) {
+                        // If we do not have a direct mater, and there is only one checker, we must have a single
+                        // discovered mater, else a double discovered mater.
+                        ++ext_perft->single_discovered_mates;
+                    } else {
+                        ++ext_perft->double_discovered_mates;
+                    }
+                }
+            }
+        }
+
+        return move_count;
+    }
+
+    nodes = 0;
+    struct PositionInfo position_info;
+    for (size_t i = 0; i < move_count; ++i) {
+        do_move(position, &position_info, movelist[i]);
+        nodes += extended_perft_nonzero_depth(position, depth - 1, counters, table);
+        undo_move(position, movelist[i]);
+    }
+
+    if (use_table) {
+        store_perft_table(table, key, nodes, &subtree);
+        add_extended_perft(ext_perft, &subtree);
+    }
+
+    return nodes;
+}
+
+// A subtree of a parallel perft, reached from the root by the moves in `moves`.
+struct PerftItem {
+    Move moves[OPTION_PERFT_SPLIT_DEPTH_MAX];
+    size_t root_move_index;  // The index of the first move in the root moves.
+    size_t nodes;
+};
+
+// A parallel perft divides the subtrees at `split_depth` plies from the root over the threads. The threads take the
+// next subtree by incrementing `next_item` whenever they are done with one, such that threads that finish early keep
+// taking work until none is left.
+struct PerftJob {
+    const struct Position* root_position;
+    size_t split_depth;
+    size_t depth;  // The depth of the subtrees.
+
+    struct PerftItem* items;
+    size_t item_count;
+    size_t item_capacity;
+
+    _Atomic(size_t) next_item;
+
+    // Every thread counts into its own extended perft, or none are used if this is a regular perft.
+    struct ExtendedPerft* ext_perfts;
+
+    // The perft table shared by all threads, or a null pointer if it is disabled.
+    struct PerftTable* table;
+};
+
+
+// Adds a subtree of `job` for every line of legal moves of `ply` moves from `position`, where `moves` holds the moves
+// of the line so far. Returns `false` if the subtrees could not be allocated.
+static bool collect_perft_items(struct PerftJob* job, struct Position* position, Move moves[static 1], const size_t ply,
+                                const size_t root_move_index) {
+    assert(job != nullptr);
+    assert(position != nullptr);
+    assert(moves != nullptr);
+
+    if (ply == job->split_depth) {
+        if (job->item_count == job->item_capacity) {
+            const size_t capacity   = (job->item_capacity == 0) ? 256 : 2 * job->item_capacity;
+            struct PerftItem* items = realloc(job->items, capacity * sizeof(*job->items));
+            if (items == nullptr)
+                return false;
+
+            job->items         = items;
+            job->item_capacity = capacity;
+        }
+
+        struct PerftItem* item = &job->items[job->item_count++];
+        memcpy(item->moves, moves, ply * sizeof(*moves));
+        item->root_move_index = root_move_index;
+        item->nodes           = 0;
+        return true;
+    }
+
+    Move movelist[MAX_MOVES];
+    const size_t move_count = generate_legal_moves(position, movelist);
+
+    struct PositionInfo position_info;
+    for (size_t i = 0; i < move_count; ++i) {
+        moves[ply] = movelist[i];
+
+        do_move(position, &position_info, movelist[i]);
+        const bool collected = collect_perft_items(job, position, moves, ply + 1, (ply == 0) ? i : root_move_index);
+        undo_move(position, movelist[i]);
+
+        if (!collected)
+            return false;
+    }
+
+    return true;
+}
+
+// Computes the subtrees of the perft job `job_` until no subtrees are left.
+static void perft_task(void* job_, const size_t thread_index) {
+    assert(job_ != nullptr);
+
+    struct PerftJob* job = (struct PerftJob*)job_;
+
+    // Every thread works on its own copy of the root position.
+    struct Position position;
+    struct PositionInfo root_info;
+    memcpy(&position, job->root_position, sizeof(position));
+    memcpy(&root_info, job->root_position->info, sizeof(root_info));
+    position.info = &root_info;
+
+    struct ExtendedPerft* ext_perft = (job->ext_perfts != nullptr) ? &job->ext_perfts[thread_index] : nullptr;
+
+    struct PositionInfo infos[OPTION_PERFT_SPLIT_DEPTH_MAX];
+    size_t index;
+    while ((index = atomic_fetch_add(&job->next_item, 1)) < job->item_count) {
+        struct PerftItem* item = &job->items[index];
+
+        for (size_t i = 0; i < job->split_depth; ++i)
+            do_move(&position, &infos[i], item->moves[i]);
+
+        if (job->depth == 0)
+            item->nodes = 1;
+        else if (ext_perft != nullptr)
+            item->nodes = extended_perft_nonzero_depth(&position, job->depth, ext_perft, job->table);
+        else
+            item->nodes = perft_nonzero_depth(&position, job->depth, job->table);
+
+        for (size_t i = job->split_depth; i-- > 0;)
+            undo_move(&position, item->moves[i]);
+    }
+}
+
+// Sets up `job` to compute perft at `depth` in `position` with the subtrees at `split_depth` plies from the root, and
+// computes them with the threads of `thread_pool`. Stores the total number of nodes in `nodes` and returns `true`, or
+// prints an info string and returns `false` if the subtrees could not be allocated. The subtrees are kept in `job` and
+// must be freed by the caller in either case.
+static bool run_perft_job(struct PerftJob* job, struct ThreadPool* thread_pool, struct Position* position,
+                          const size_t depth, const size_t split_depth, struct ExtendedPerft* ext_perfts,
+                          struct PerftTable* table, size_t* nodes) {
+    assert(job != nullptr);
+    assert(thread_pool != nullptr);
+    assert(position != nullptr);
+    assert(nodes != nullptr);
+    assert(split_depth <= depth && split_depth <= OPTION_PERFT_SPLIT_DEPTH_MAX);
+
+    job->root_position = position;
+    job->split_depth   = split_depth;
+    job->depth         = depth - split_depth;
+    job->items         = nullptr;
+    job->item_count    = 0;
+    job->item_capacity = 0;
+    job->ext_perfts    = ext_perfts;
+    job->table         = table;
+    atomic_store(&job->next_item, 0);
+
+    Move moves[OPTION_PERFT_SPLIT_DEPTH_MAX + 1];
+    if (!collect_perft_items(job, position, moves, 0, 0)) {
+        puts("info string could not allocate the perft subtrees");
+        return false;
+    }
+
+    run_task(thread_pool, perft_task, job);
+
+    *nodes = 0;
+    for (size_t i = 0; i < job->item_count; ++i)
+        *nodes += job->items[i].nodes;
+
+    return true;
+}
+
+// Returns the split depth for a perft at `depth` with `thread_pool`. The subtrees must at least be 1 ply deep, as the
+// extended perft only counts at the leaves of the subtrees. The option is clamped, as the split moves are stored in
+// arrays of OPTION_PERFT_SPLIT_DEPTH_MAX moves.
+static size_t perft_split_depth(const struct ThreadPool* thread_pool, const size_t depth) {
+    assert(thread_pool != nullptr);
+    assert(depth > 0);
+
+    size_t split_depth = thread_pool->options->perft_split_depth;
+    split_depth        = (split_depth < OPTION_PERFT_SPLIT_DEPTH_MIN)   ? OPTION_PERFT_SPLIT_DEPTH_MIN
+                       : (split_depth > OPTION_PERFT_SPLIT_DEPTH_MAX) ? OPTION_PERFT_SPLIT_DEPTH_MAX
+                                                                      : split_depth;
+    return (split_depth < depth) ? split_depth : depth - 1;
+}
+
+
+size_t perft(struct ThreadPool* thread_pool, struct Position* position, const size_t depth) {
+    assert(thread_pool != nullptr);
+    assert(position != nullptr);
+
+    if (depth == 0)
+        return 1;
+
+    struct PerftTable* table = prepare_perft_table(thread_pool->options->perft_hash_size, false);
+
+    struct PerftJob job;
+    size_t nodes = 0;
+    run_perft_job(&job, thread_pool, position, depth, perft_split_depth(thread_pool, depth), nullptr, table, &nodes);
+    free(job.items);
+
+    return nodes;
+}
+
+size_t divide(struct ThreadPool* thread_pool, struct Position* position, const size_t depth) {
+    assert(thread_pool != nullptr);
+    assert(position != nullptr);
+    assert(depth > 0);
+
+    // The nodes are counted per root move, so we need to split at least at the root.
+    const size_t split_depth = perft_split_depth(thread_pool, depth);
+
+    struct PerftTable* table = prepare_perft_table(thread_pool->options->perft_hash_size, false);
+
+    struct PerftJob job;
+    size_t nodes = 0;
+    if (!run_perft_job(&job, thread_pool, position, depth, (split_depth > 0) ? split_depth : 1, nullptr, table,
+                       &nodes)) {
+        free(job.items);
+        return 0;
+    }
+
+    // The subtrees are collected in the order of the root moves.
+    Move movelist[MAX_MOVES];
+    const size_t move_count = generate_legal_moves(position, movelist);
+
+    size_t item = 0;
+    for (size_t i = 0; i < move_count; ++i) {
+        size_t move_nodes = 0;
+        while (item < job.item_count && job.items[item].root_move_index == i)
+            move_nodes += job.items[item++].nodes;
+
+        print_move(movelist[i]);
+        printf(": %zu\n", move_nodes);
+    }
+
+    free(job.items);
+
+    return nodes;
+}
+
+size_t extended_perft(struct ThreadPool* thread_pool, struct Position* position, const size_t depth,
+                      struct ExtendedPerft* ext_perft) {
+    assert(thread_pool != nullptr);
+    assert(position != nullptr);
+    assert(ext_perft != nullptr);
+
+    memset(ext_perft, 0, sizeof(*ext_perft));
+
+    if (depth == 0)
+        return 1;
+
+    struct ExtendedPerft* ext_perfts = calloc(thread_pool->thread_count, sizeof(*ext_perfts));
+    if (ext_perfts == nullptr) {
+        puts("info string could not allocate the extended perft counts");
+        return 0;
+    }
+
+    struct PerftTable* table = prepare_perft_table(thread_pool->options->perft_hash_size, true);
+
+    struct PerftJob job;
+    size_t nodes = 0;
+    run_perft_job(&job, thread_pool, position, depth, perft_split_depth(thread_pool, depth), ext_perfts, table, &nodes);
+    free(job.items);
+
+    for (size_t i = 0; i < thread_pool->thread_count; ++i)
+        add_extended_perft(ext_perft, &ext_perfts[i]);
+
+    free(ext_perfts);
+
+    return nodes;
+}
+
+void free_perft_table() {
+    free(perft_table.words);
+
+    perft_table.words       = nullptr;
+    perft_table.entry_count = 0;
+    perft_table.entry_words = 0;
+    perft_table.size        = 0;
+}
+
+
+static constexpr char PERFT_CHECKPOINT_HEADER[] = "windmolen perft checkpoint";
+static constexpr size_t PERFT_CHECKPOINT_LINE_LENGTH = 128;
+
+// The state of a perft job: the root moves, which of them are finished and their numbers of nodes.
+struct PerftJobState {
+    Move moves[MAX_MOVES];
+    size_t move_count;
+
+    bool finished[MAX_MOVES];
+    size_t nodes[MAX_MOVES];
+
+    // The checkpoint file, opened for appending.
+    FILE* checkpoint;
+};
+
+
+// Reads the finished root moves of `state` from the checkpoint `file`, which must belong to the position with Zobrist
+// key `key` and `depth`. Returns whether the checkpoint belongs to the position and depth.
+static bool read_perft_checkpoint(struct PerftJobState* state, FILE* file, const ZobristKey key, const size_t depth) {
+    assert(state != nullptr);
+    assert(file != nullptr);
+
+    char line[PERFT_CHECKPOINT_LINE_LENGTH];
+    if (fgets(line, PERFT_CHECKPOINT_LINE_LENGTH, file) == nullptr)
+        return true;  // An empty file is a new checkpoint.
+
+    ZobristKey checkpoint_key;
+    size_t checkpoint_depth;
+    const size_t header_length = strlen(PERFT_CHECKPOINT_HEADER);
+    if (strncmp(line, PERFT_CHECKPOINT_HEADER, header_length) != 0
+        || sscanf(line + header_length, "%" SCNx64 " %zu", &checkpoint_key, &checkpoint_depth) != 2
+        || checkpoint_key != key || checkpoint_depth != depth)
+        return false;
+
+    // Every finished root move ends with a period, such that a line that was cut off by a crash is ignored.
+    while (fgets(line, PERFT_CHECKPOINT_LINE_LENGTH, file) != nullptr) {
+        char move_string[MOVE_STRING_SIZE];
+        size_t nodes;
+        char end;
+        if (sscanf(line, "%5s %zu%c", move_string, &nodes, &end) != 3 || end != '.')
+            continue;
+
+        for (size_t i = 0; i < state->move_count; ++i) {
+            char root_move_string[MOVE_STRING_SIZE];
+            move_to_string(state->moves[i], root_move_string);
+            if (strcmp(move_string, root_move_string) == 0) {
+                state->finished[i] = true;
+                state->nodes[i]    = nodes;
+            }
+        }
+    }
+
+    return true;
+}
+
+// Marks root move `index` of `state` as finished with `nodes` nodes, and appends it to the checkpoint.
+static void finish_perft_job_move(struct PerftJobState* state, const size_t index, const size_t nodes) {
+    assert(state != nullptr);
+    assert(index < state->move_count);
+
+    state->finished[index] = true;
+    state->nodes[index]    = nodes;
+
+    char move_string[MOVE_STRING_SIZE];
+    move_to_string(state->moves[index], move_string);
+    fprintf(state->checkpoint, "%s %zu.\n", move_string, nodes);
+
+    // The checkpoint must survive the engine crashing or the host going down.
+    fflush(state->checkpoint);
+    fsync(fileno(state->checkpoint));
+}
+
+// Computes the unfinished root moves of `state` in `position` at `depth` one after another, with every root move
+// divided over the threads of `thread_pool`.
+static void run_perft_job_in_process(struct PerftJobState* state, struct ThreadPool* thread_pool,
+                                     struct Position* position, const size_t depth) {
+    assert(state != nullptr);
+    assert(thread_pool != nullptr);
+    assert(position != nullptr);
+    assert(depth > 0);
+
+    struct PositionInfo position_info;
+    for (size_t i = 0; i < state->move_count; ++i) {
+        if (state->finished[i])
+            continue;
+
+        do_move(position, &position_info, state->moves[i]);
+        const size_t nodes = perft(thread_pool, position, depth - 1);
+        undo_move(position, state->moves[i]);
+
+        finish_perft_job_move(state, i, nodes);
+    }
+}
+
+// Computes the unfinished root moves of `state` in `position` at `depth` with `process_count` forked worker processes,
+// which take turns in picking the root moves. The threads of the thread pool do not exist in the workers, so every
+// worker computes its root moves on its own, with its own copy of the perft table of size `hash_size`. The workers send
+// their results through a pipe to this process, which writes the checkpoint. Returns `false` if the workers could not
+// be started, in which case nothing has been computed.
+static bool run_perft_job_workers(struct PerftJobState* state, struct Position* position, const size_t depth,
+                                  const size_t process_count, const uint64_t hash_size) {
+    assert(state != nullptr);
+    assert(position != nullptr);
+    assert(depth > 0);
+    assert(process_count > 1);
+
+    int pipe_ends[2];
+    if (pipe(pipe_ends) != 0)
+        return false;
+
+    // Buffered output would otherwise be written by every worker as well.
+    fflush(stdout);
+    fflush(state->checkpoint);
+
+    size_t worker_count = 0;
+    pid_t workers[PERFT_JOB_MAX_PROCESSES];
+    for (size_t worker = 0; worker < process_count; ++worker) {
+        const pid_t pid = fork();
+        if (pid < 0)
+            break;
+
+        if (pid == 0) {
+            close(pipe_ends[0]);
+
+            struct PerftTable* table = prepare_perft_table(hash_size, false);
+
+            struct PositionInfo position_info;
+            size_t unfinished = 0;
+            for (size_t i = 0; i < state->move_count; ++i) {
+                if (state->finished[i] || unfinished++ % process_count != worker)
+                    continue;
+
+                do_move(position, &position_info, state->moves[i]);
+                const size_t nodes = (depth == 1) ? 1 : perft_nonzero_depth(position, depth - 1, table);
+                undo_move(position, state->moves[i]);
+
+                // Lines are shorter than PIPE_BUF, so the lines of different workers are never interleaved.
+                dprintf(pipe_ends[1], "%zu %zu\n", i, nodes);
+            }
+
+            _exit(EXIT_SUCCESS);
+        }
+
+        workers[worker_count++] = pid;
+    }
+
+    close(pipe_ends[1]);
+
+    // If not all workers could be started, the root moves of the missing workers are left for the next run.
+    FILE* results = fdopen(pipe_ends[0], "r");
+    char line[PERFT_CHECKPOINT_LINE_LENGTH];
+    while (results != nullptr && fgets(line, PERFT_CHECKPOINT_LINE_LENGTH, results) != nullptr) {
+        size_t index;
+        size_t nodes;
+        if (sscanf(line, "%zu %zu", &index, &nodes) == 2 && index < state->move_count)
+            finish_perft_job_move(state, index, nodes);
+    }
+
+    if (results != nullptr)
+        fclose(results);
+    else
+        close(pipe_ends[0]);
+
+    for (size_t i = 0; i < worker_count; ++i)
+        waitpid(workers[i], nullptr, 0);
+
+    return worker_count > 0;
+}
+
+bool perft_job(struct ThreadPool* thread_pool, struct Position* position, const size_t depth, const char* path,
+               const size_t process_count) {
+    assert(thread_pool != nullptr);
+    assert(position != nullptr);
+    assert(depth > 0);
+    assert(path != nullptr);
+    assert(process_count > 0 && process_count <= PERFT_JOB_MAX_PROCESSES);
+
+    struct PerftJobState state;
+    state.move_count = generate_legal_moves(position, state.moves);
+    memset(state.finished, 0, sizeof(state.finished));
+    memset(state.nodes, 0, sizeof(state.nodes));
+
+    // A checkpoint that was cut off in the middle of a line is continued on a new line.
+    int last_character = EOF;
+    FILE* file         = fopen(path, "r");
+    if (file != nullptr) {
+        const bool valid = read_perft_checkpoint(&state, file, zobrist_key(position), depth);
+        if (fseek(file, -1, SEEK_END) == 0)
+            last_character = fgetc(file);
+        fclose(file);
+
+        if (!valid)
+            return false;
+    }
+
+    state.checkpoint = fopen(path, "a");
+    if (state.checkpoint == nullptr)
+        return false;
+
+    if (last_character != EOF && last_character != '\n')
+        fputc('\n', state.checkpoint);
+
+    if (last_character == EOF) {
+        fprintf(state.checkpoint, "%s %016" PRIx64 " %zu\n", PERFT_CHECKPOINT_HEADER, zobrist_key(position), depth);
+        fflush(state.checkpoint);
+    }
+
+    bool done = false;
+    if (process_count > 1)
+        done = run_perft_job_workers(&state, position, depth, process_count, thread_pool->options->perft_hash_size);
+    if (!done)
+        run_perft_job_in_process(&state, thread_pool, position, depth);
+
+    fclose(state.checkpoint);
+
+    size_t nodes      = 0;
+    size_t unfinished = 0;
+    for (size_t i = 0; i < state.move_count; ++i) {
+        print_move(state.moves[i]);
+        if (state.finished[i])
+            printf(": %zu\n", state.nodes[i]);
+        else
+            printf(": unfinished\n");
+
+        nodes += state.nodes[i];
+        unfinished += !state.finished[i];
+    }
+
+    if (unfinished == 0)
+        printf("\nNodes searched: %zu\n", nodes);
+    else
+        printf("\n%zu root moves are unfinished, run the job again to resume it\n", unfinished);
+
+    return true;
+}
+
+
+// The deepest perft depth of a perft suite that is tested.
+static constexpr size_t PERFT_SUITE_MAX_DEPTH   = 16;
+static constexpr size_t PERFT_SUITE_LINE_LENGTH = 1024;
+
+// A position of a perft suite, together with the expected and the computed perft results.
+struct PerftSuiteEntry {
+    char fen[PERFT_SUITE_LINE_LENGTH];
+
+    // The node counts at depths 1 up to `max_depth` are tested.
+    size_t expected_nodes[PERFT_SUITE_MAX_DEPTH + 1];
+    size_t max_depth;
+
+    // The first depth at which the node count was wrong, or 0 if all node counts were right.
+    size_t failed_depth;
+    size_t failed_nodes;
+
+    uint64_t nodes;
+    uint64_t time;
+};
+
+// The positions of a perft suite are handed out to the threads by incrementing `next_entry`.
+struct PerftSuite {
+    struct PerftSuiteEntry* entries;
+    size_t entry_count;
+
+    _Atomic(size_t) next_entry;
+};
+
+
+// Parses an EPD `line` of the form "<fen> ;D1 <nodes> ;D2 <nodes> ..." into `entry`, testing at most `max_depth`
+// depths. Returns whether the line contains a position with at least one expected node count.
+static bool parse_perft_suite_line(struct PerftSuiteEntry* entry, const char* line, const size_t max_depth) {
+    assert(entry != nullptr);
+    assert(line != nullptr);
+
+    const char* fields = strchr(line, ';');
+    if (fields == nullptr)
+        return false;
+
+    size_t fen_length = (size_t)(fields - line);
+    while (fen_length > 0 && isspace((unsigned char)line[fen_length - 1]))
+        --fen_length;
+    memcpy(entry->fen, line, fen_length);
+    entry->fen[fen_length] = '\0';
+
+    memset(entry->expected_nodes, 0, sizeof(entry->expected_nodes));
+    entry->max_depth = 0;
+    while (fields != nullptr) {
+        ++fields;
+        while (isspace((unsigned char)*fields))
+            ++fields;
+
+        if (*fields == 'D') {
+            char* end;
+            const size_t depth = (size_t)strtoull(fields + 1, &end, 10);
+            if (depth > 0 && depth <= max_depth && depth <= PERFT_SUITE_MAX_DEPTH) {
+                entry->expected_nodes[depth] = (size_t)strtoull(end, nullptr, 10);
+                if (depth > entry->max_depth)
+                    entry->max_depth = depth;
+            }
+        }
+
+        fields = strchr(fields, ';');
+    }
+
+    entry->failed_depth = 0;
+    entry->failed_nodes = 0;
+    entry->nodes        = 0;
+    entry->time         = 0;
+
+    return entry->max_depth > 0;
+}
+
+// Runs perft on the positions of the perft suite `suite_` until no positions are left.
+static void perft_suite_task(void* suite_, [[maybe_unused]] const size_t thread_index) {
+    assert(suite_ != nullptr);
+
+    struct PerftSuite* suite = (struct PerftSuite*)suite_;
+
+    size_t index;
+    while ((index = atomic_fetch_add(&suite->next_entry, 1)) < suite->entry_count) {
+        struct PerftSuiteEntry* entry = &suite->entries[index];
+
+        struct Position position;
+        struct PositionInfo info;
+        setup_position_from_fen(&position, &info, entry->fen);
+
+        const uint64_t start_time = get_time_us();
+
+        for (size_t depth = 1; depth <= entry->max_depth; ++depth) {
+            const size_t nodes = perft_nonzero_depth(&position, depth, nullptr);
+            entry->nodes += nodes;
+
+            // A position may skip depths in the EPD file, those are only counted.
+            if (entry->expected_nodes[depth] != 0 && nodes != entry->expected_nodes[depth]) {
+                entry->failed_depth = depth;
+                entry->failed_nodes = nodes;
+                break;
+            }
+        }
+
+        entry->time = get_time_us() - start_time;
+    }
+}
+
+bool perft_suite(struct ThreadPool* thread_pool, const char* path, const size_t max_depth, const size_t thread_count) {
+    assert(thread_pool != nullptr);
+    assert(path != nullptr);
+    assert(max_depth > 0);
+    assert(thread_count >= OPTION_THREAD_COUNT_MIN && thread_count <= OPTION_THREAD_COUNT_MAX);
+
+    FILE* file = fopen(path, "r");
+    if (file == nullptr)
+        return false;
+
+    struct PerftSuite suite = {.entries = nullptr, .entry_count = 0};
+    size_t capacity         = 0;
+
+    char line[PERFT_SUITE_LINE_LENGTH];
+    size_t line_number = 0;
+    while (fgets(line, PERFT_SUITE_LINE_LENGTH, file) != nullptr) {
+        ++line_number;
+
+        // The remainder of a line that does not fit in the buffer would be parsed as a position of its own, so the
+        // whole line is skipped.
+        if (strchr(line, '\n') == nullptr && !feof(file)) {
+            printf("info string skipping line %zu of %s, which is longer than %zu characters\n", line_number, path,
+                   PERFT_SUITE_LINE_LENGTH - 2);
+
+            int character;
+            while ((character = fgetc(file)) != EOF && character != '\n') {}
+            continue;
+        }
+
+        if (suite.entry_count == capacity) {
+            capacity                        = (capacity == 0) ? 64 : 2 * capacity;
+            struct PerftSuiteEntry* entries = realloc(suite.entries, capacity * sizeof(*suite.entries));
+            if (entries == nullptr) {
+                free(suite.entries);
+                fclose(file);
+                return false;
+            }
+            suite.entries = entries;
+        }
+
+        if (parse_perft_suite_line(&suite.entries[suite.entry_count], line, max_depth))
+            ++suite.entry_count;
+    }
+
+    fclose(file);
+
+    const size_t previous_thread_count = thread_pool->thread_count;
+    if (thread_count != previous_thread_count)
+        resize_thread_pool(thread_pool, thread_count);
+
+    atomic_store(&suite.next_entry, 0);
+
+    const uint64_t start_time = get_time_us();
+    run_task(thread_pool, perft_suite_task, &suite);
+    const uint64_t total_time = get_time_us() - start_time;
+
+    if (thread_count != previous_thread_count)
+        resize_thread_pool(thread_pool, previous_thread_count);
+
+    size_t passed        = 0;
+    uint64_t total_nodes = 0;
+    for (size_t i = 0; i < suite.entry_count; ++i) {
+        const struct PerftSuiteEntry* entry = &suite.entries[i];
+        const uint64_t nps                  = (entry->time == 0) ? 0 : 1000000 * entry->nodes / entry->time;
+
+        printf("%3zu %s: %s (%" PRIu64 " ms, %" PRIu64 " nps)\n", i + 1, entry->fen,
+               (entry->failed_depth == 0) ? "passed" : "failed", entry->time / 1000, nps);
+        if (entry->failed_depth != 0)
+            printf("    Incorrect value at depth %zu: expected %zu, got %zu\n", entry->failed_depth,
+                   entry->expected_nodes[entry->failed_depth], entry->failed_nodes);
+
+        passed += (entry->failed_depth == 0);
+        total_nodes += entry->nodes;
+    }
+
+    const uint64_t nps = (total_time == 0) ? 0 : 1000000 * total_nodes / total_time;
+
+    printf("\nPassed %zu/%zu\n", passed, suite.entry_count);
+    printf("Total time (ms) : %" PRIu64 "\n", total_time / 1000);
+    printf("Nodes searched  : %" PRIu64 "\n", total_nodes);
+    printf("Nodes/second    : %" PRIu64 "\n", nps);
+
+    free(suite.entries);
+
+    return true;
+}
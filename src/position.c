@@ -139,7 +139,9 @@ void do_move(struct Position* position, struct PositionInfo* new_info, const Mov
     assert(new_info != position->info);
     assert(!is_weird_move(move));
 
-    ZobristKey zobrist_key = position->info->zobrist_key ^ side_to_move_zobrist_key;
+    ZobristKey zobrist_key  = position->info->zobrist_key ^ side_to_move_zobrist_key;
+    ZobristKey pawn_key     = position->info->pawn_key;
+    ZobristKey material_key = position->info->material_key;
 
     // Copy information from previous info and switch to new info. new_info will be used to update position->info fields
     // later in this function.
@@ -147,6 +149,11 @@ void do_move(struct Position* position, struct PositionInfo* new_info, const Mov
     new_info->previous_info = position->info;
     position->info          = new_info;
 
+    // The accumulator of the new position is only computed when it is evaluated.
+    new_info->dirty_pieces.count                = 0;
+    new_info->accumulator.computed[COLOR_WHITE] = false;
+    new_info->accumulator.computed[COLOR_BLACK] = false;
+
     const enum Color side_to_move = position->side_to_move;
     const enum Color opponent     = opposite_color(side_to_move);
 
@@ -185,6 +192,9 @@ void do_move(struct Position* position, struct PositionInfo* new_info, const Mov
     } else if (captured_piece != PIECE_NONE) {
         enum Square captured_square = destination;
 
+        // The last piece of the kind of the captured piece disappears from the material key.
+        material_key ^= piece_zobrist_keys[captured_piece][piece_count(position, captured_piece) - 1];
+
         if (move_type == MOVE_TYPE_EN_PASSANT) {
             captured_square = square_step(destination,
                                           (side_to_move == COLOR_WHITE) ? DIRECTION_SOUTH : DIRECTION_NORTH);
@@ -195,6 +205,8 @@ void do_move(struct Position* position, struct PositionInfo* new_info, const Mov
 
         // Update the Zobrist key for the captured piece.
         zobrist_key ^= piece_zobrist_keys[captured_piece][captured_square];
+        if (type_of_piece(captured_piece) == PIECE_TYPE_PAWN)
+            pawn_key ^= piece_zobrist_keys[captured_piece][captured_square];
 
         new_info->halfmove_clock = 0;  // Irreversible move was played.
     }
@@ -209,6 +221,11 @@ void do_move(struct Position* position, struct PositionInfo* new_info, const Mov
     zobrist_key ^= piece_zobrist_keys[piece][source];
 
     if (type_of_piece(piece) == PIECE_TYPE_PAWN) {
+        // The pawn leaves its source square, and only arrives at its destination if it does not promote.
+        pawn_key ^= piece_zobrist_keys[piece][source];
+        if (move_type != MOVE_TYPE_PROMOTION)
+            pawn_key ^= piece_zobrist_keys[piece][destination];
+
         // Clever trick to detect a double pawn push.
         if (((int)source ^ (int)destination) == 16) {
             // Update en passant square only if it can result in a legal en passant capture. Otherwise, the position is
@@ -242,7 +259,11 @@ void do_move(struct Position* position, struct PositionInfo* new_info, const Mov
                 }
             }
         } else if (move_type == MOVE_TYPE_PROMOTION) {
+            material_key ^= piece_zobrist_keys[piece][piece_count(position, piece) - 1];
+
             piece = create_piece(side_to_move, promotion_piece_type(move));  // Change piece in case of promotion.
+
+            material_key ^= piece_zobrist_keys[piece][piece_count(position, piece)];
         }
 
         new_info->halfmove_clock = 0;  // Irreversible move was played.
@@ -293,8 +314,10 @@ void do_move(struct Position* position, struct PositionInfo* new_info, const Mov
     // Update side to move.
     position->side_to_move = opponent;
 
-    // Update the position Zobrist key.
-    new_info->zobrist_key = zobrist_key;
+    // Update the position Zobrist keys.
+    new_info->zobrist_key  = zobrist_key;
+    new_info->pawn_key     = pawn_key;
+    new_info->material_key = material_key;
 
     // At this point, the Zobrist key has been calculated so we can update repetition.
     new_info->repetition = compute_repetition(position);
@@ -425,6 +448,9 @@ const char* setup_position_from_fen(struct Position* position, struct PositionIn
             place_piece(position, piece, square);
 
             info->zobrist_key ^= piece_zobrist_keys[piece][square];
+            if (type_of_piece(piece) == PIECE_TYPE_PAWN)
+                info->pawn_key ^= piece_zobrist_keys[piece][square];
+            info->material_key ^= piece_zobrist_keys[piece][piece_count(position, piece) - 1];
 
             if (piece == PIECE_WHITE_KING)
                 position->king_square[COLOR_WHITE] = square;
@@ -602,11 +628,21 @@ void print_position_debug(const struct Position* position) {
     print_position(position);
     putchar('\n');
 
-    printf("Middle game score (white -- black): %d -- %d\n", position->info->middle_game_score[COLOR_WHITE],
-           position->info->middle_game_score[COLOR_BLACK]);
-    printf("End game score (white -- black):    %d -- %d\n", position->info->end_game_score[COLOR_WHITE],
-           position->info->end_game_score[COLOR_BLACK]);
+    // The piece-square scores are not used by the search, so they are only computed here.
+    PackedScore piece_square_scores[COLOR_COUNT] = {0};
+    for (enum Square square = SQUARE_A1; square < SQUARE_COUNT; ++square) {
+        const enum Piece piece = piece_on_square(position, square);
+        if (piece != PIECE_NONE)
+            piece_square_scores[color_of_piece(piece)] += piece_square_score[piece][square];
+    }
+
+    printf("Middle game score (white -- black): %d -- %d\n", middle_game_value(piece_square_scores[COLOR_WHITE]),
+           middle_game_value(piece_square_scores[COLOR_BLACK]));
+    printf("End game score (white -- black):    %d -- %d\n", end_game_value(piece_square_scores[COLOR_WHITE]),
+           end_game_value(piece_square_scores[COLOR_BLACK]));
     printf("Game phase:                         %d\n", position->info->game_phase);
+    printf("Pawn hash:                          0x%016" PRIx64 "\n", position->info->pawn_key);
+    printf("Material hash:                      0x%016" PRIx64 "\n", position->info->material_key);
     putchar('\n');
 
     printf("Repetition:                         %d\n", position->info->repetition);
@@ -6,6 +6,7 @@
 #include <stddef.h>
 #include <stdint.h>
 
+#include "accumulator.h"
 #include "bitboard.h"
 #include "move.h"
 #include "score.h"
@@ -24,16 +25,25 @@ struct PositionInfo {
     enum Square en_passant_square;
     size_t halfmove_clock;
 
-    Value middle_game_score[COLOR_COUNT];
-    Value end_game_score[COLOR_COUNT];
     int game_phase;
 
+    // The Zobrist key of only the pawns, which identifies the pawn structure.
+    ZobristKey pawn_key;
+    // The Zobrist key of the number of pieces of every kind, which identifies the material configuration. The nth piece
+    // of a kind contributes the key of that piece on the nth square.
+    ZobristKey material_key;
+
     struct PositionInfo* previous_info;
     ZobristKey zobrist_key;
     Bitboard checkers;
     Bitboard blockers[COLOR_COUNT];
     enum Piece captured_piece;
     int repetition;
+
+    // The network accumulator of this position, which is computed lazily from the accumulator of a previous position by
+    // applying the dirty pieces of the moves in between.
+    struct DirtyPieces dirty_pieces;
+    struct Accumulator accumulator;
 };
 
 // Structure that describes a chess position.
@@ -60,6 +70,20 @@ static INLINE ZobristKey zobrist_key(const struct Position* position) {
     return position->info->zobrist_key;
 }
 
+// Returns the Zobrist key of the pawns of `position`.
+static INLINE ZobristKey pawn_key(const struct Position* position) {
+    assert(position != nullptr);
+
+    return position->info->pawn_key;
+}
+
+// Returns the Zobrist key of the material of `position`.
+static INLINE ZobristKey material_key(const struct Position* position) {
+    assert(position != nullptr);
+
+    return position->info->material_key;
+}
+
 
 // Returns which piece is on `square` in `position`.
 static INLINE enum Piece piece_on_square(const struct Position* position, const enum Square square) {
@@ -96,6 +120,14 @@ static INLINE Bitboard piece_occupancy(const struct Position* position, const en
     return piece_occupancy_by_type(position, piece_type) & piece_occupancy_by_color(position, color);
 }
 
+// Returns the number of pieces `piece` in `position`.
+static INLINE size_t piece_count(const struct Position* position, const enum Piece piece) {
+    assert(position != nullptr);
+    assert(is_valid_piece(piece));
+
+    return (size_t)popcount64(piece_occupancy(position, color_of_piece(piece), type_of_piece(piece)));
+}
+
 // Returns a bitboard of the occupancy of bishops and queens in `position`.
 static INLINE Bitboard bishop_queen_occupancy_by_type(const struct Position* position) {
     assert(position != nullptr);
@@ -174,9 +206,9 @@ static INLINE void place_piece(struct Position* position, const enum Piece piece
     position->occupancy_by_type[piece_type] |= bitboard;
     position->occupancy_by_color[piece_color] |= bitboard;
 
-    position->info->middle_game_score[piece_color] += piece_square_value_middle_game[piece][square];
-    position->info->end_game_score[piece_color] += piece_square_value_end_game[piece][square];
     position->info->game_phase += game_phase_increment[piece_type];
+
+    add_dirty_piece(&position->info->dirty_pieces, piece, SQUARE_NONE, square);
 }
 
 // Removes `piece` from `square` in `position`.
@@ -197,9 +229,9 @@ static INLINE void remove_piece(struct Position* position, const enum Square squ
     position->occupancy_by_type[piece_type] ^= bitboard;
     position->occupancy_by_color[piece_color] ^= bitboard;
 
-    position->info->middle_game_score[piece_color] -= piece_square_value_middle_game[piece][square];
-    position->info->end_game_score[piece_color] -= piece_square_value_end_game[piece][square];
     position->info->game_phase -= game_phase_increment[piece_type];
+
+    add_dirty_piece(&position->info->dirty_pieces, piece, square, SQUARE_NONE);
 }
 
 // Replaces a piece on `square` with `piece` in `position`.
@@ -228,11 +260,9 @@ static INLINE void move_piece(struct Position* position, const enum Square sourc
     position->occupancy_by_type[type_of_piece(piece)] ^= bitboard;
     position->occupancy_by_color[piece_color] ^= bitboard;
 
-    position->info->middle_game_score[piece_color] += piece_square_value_middle_game[piece][destination]
-                                                    - piece_square_value_middle_game[piece][source];
-    position->info->end_game_score[piece_color] += piece_square_value_end_game[piece][destination]
-                                                 - piece_square_value_end_game[piece][source];
     // Game phase does not change.
+
+    add_dirty_piece(&position->info->dirty_pieces, piece, source, destination);
 }
 
 
@@ -0,0 +1,180 @@
+#include "profiler.h"
+
+#include <assert.h>
+#include <inttypes.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#ifdef __linux__
+#    include <linux/perf_event.h>
+#    include <sys/ioctl.h>
+#    include <sys/syscall.h>
+#    include <unistd.h>
+#endif /* #ifdef __linux__ */
+
+
+
+#ifdef __linux__
+// Sets the type and the configuration of `attributes` such that they describe `event`.
+static void set_perf_event(struct perf_event_attr* attributes, const enum PerfEvent event) {
+    assert(attributes != nullptr);
+
+    // Cache events are configured by the cache, the operation and the result.
+    constexpr uint64_t READ_MISS = (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+
+    switch (event) {
+        case PERF_EVENT_CYCLES:
+            attributes->type   = PERF_TYPE_HARDWARE;
+            attributes->config = PERF_COUNT_HW_CPU_CYCLES;
+            break;
+        case PERF_EVENT_INSTRUCTIONS:
+            attributes->type   = PERF_TYPE_HARDWARE;
+            attributes->config = PERF_COUNT_HW_INSTRUCTIONS;
+            break;
+        case PERF_EVENT_L1D_MISSES:
+            attributes->type   = PERF_TYPE_HW_CACHE;
+            attributes->config = PERF_COUNT_HW_CACHE_L1D | READ_MISS;
+            break;
+        case PERF_EVENT_LLC_MISSES:
+            attributes->type   = PERF_TYPE_HARDWARE;
+            attributes->config = PERF_COUNT_HW_CACHE_MISSES;
+            break;
+        case PERF_EVENT_BRANCH_MISSES:
+            attributes->type   = PERF_TYPE_HARDWARE;
+            attributes->config = PERF_COUNT_HW_BRANCH_MISSES;
+            break;
+        case PERF_EVENT_DTLB_MISSES:
+            attributes->type   = PERF_TYPE_HW_CACHE;
+            attributes->config = PERF_COUNT_HW_CACHE_DTLB | READ_MISS;
+            break;
+        default:
+            assert(false);
+    }
+}
+#endif /* #ifdef __linux__ */
+
+
+// Prints the instructions per cycle and the events per node of `profile`.
+static void print_perf_profile(const struct PerfProfile* profile) {
+    assert(profile != nullptr);
+
+    static const char* const event_names[PERF_EVENT_COUNT] = {
+        [PERF_EVENT_CYCLES]        = "Cycles/node",
+        [PERF_EVENT_INSTRUCTIONS]  = "Instructions/node",
+        [PERF_EVENT_L1D_MISSES]    = "L1d misses/node",
+        [PERF_EVENT_LLC_MISSES]    = "LLC misses/node",
+        [PERF_EVENT_BRANCH_MISSES] = "Branch misses/node",
+        [PERF_EVENT_DTLB_MISSES]   = "dTLB misses/node",
+    };
+
+    printf("%-18s : %" PRIu64 "\n", "Nodes", profile->nodes);
+
+    if (profile->counted[PERF_EVENT_CYCLES] && profile->counted[PERF_EVENT_INSTRUCTIONS]
+        && profile->counts[PERF_EVENT_CYCLES] > 0)
+        printf("%-18s : %.2f\n", "IPC",
+               (double)profile->counts[PERF_EVENT_INSTRUCTIONS] / (double)profile->counts[PERF_EVENT_CYCLES]);
+
+    for (size_t i = 0; i < PERF_EVENT_COUNT; ++i) {
+        if (profile->counted[i] && profile->nodes > 0)
+            printf("%-18s : %.2f\n", event_names[i], (double)profile->counts[i] / (double)profile->nodes);
+        else
+            printf("%-18s : unavailable\n", event_names[i]);
+    }
+}
+
+
+void start_perf_counters(struct PerfCounters* counters) {
+    assert(counters != nullptr);
+
+    for (size_t i = 0; i < PERF_EVENT_COUNT; ++i) {
+        counters->file_descriptors[i] = -1;
+
+#ifdef __linux__
+        struct perf_event_attr attributes;
+        memset(&attributes, 0, sizeof(attributes));
+        attributes.size           = sizeof(attributes);
+        attributes.disabled       = 1;
+        attributes.exclude_kernel = 1;
+        attributes.exclude_hv     = 1;
+
+        // When there are more events than hardware counters, the kernel multiplexes them, so we need the time an event
+        // was actually counted to extrapolate its count.
+        attributes.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+        set_perf_event(&attributes, (enum PerfEvent)i);
+
+        // The counter follows the calling thread on any CPU.
+        const long file_descriptor = syscall(SYS_perf_event_open, &attributes, 0, -1, -1, 0);
+        if (file_descriptor < 0)
+            continue;
+
+        counters->file_descriptors[i] = (int)file_descriptor;
+#endif /* #ifdef __linux__ */
+    }
+
+#ifdef __linux__
+    // The counters are enabled together, such that they measure the same work.
+    for (size_t i = 0; i < PERF_EVENT_COUNT; ++i) {
+        if (counters->file_descriptors[i] >= 0) {
+            ioctl(counters->file_descriptors[i], PERF_EVENT_IOC_RESET, 0);
+            ioctl(counters->file_descriptors[i], PERF_EVENT_IOC_ENABLE, 0);
+        }
+    }
+#endif /* #ifdef __linux__ */
+}
+
+void stop_perf_counters(struct PerfCounters* counters, struct PerfProfile* profile) {
+    assert(counters != nullptr);
+    assert(profile != nullptr);
+
+#ifdef __linux__
+    for (size_t i = 0; i < PERF_EVENT_COUNT; ++i)
+        if (counters->file_descriptors[i] >= 0)
+            ioctl(counters->file_descriptors[i], PERF_EVENT_IOC_DISABLE, 0);
+
+    for (size_t i = 0; i < PERF_EVENT_COUNT; ++i) {
+        const int file_descriptor = counters->file_descriptors[i];
+        if (file_descriptor < 0)
+            continue;
+
+        // The count, the time enabled and the time running.
+        uint64_t values[3];
+        if (read(file_descriptor, values, sizeof(values)) == (ssize_t)sizeof(values) && values[2] > 0) {
+            const double scale = (double)values[1] / (double)values[2];
+            profile->counts[i] += (uint64_t)((double)values[0] * scale);
+            profile->counted[i] = true;
+        }
+
+        close(file_descriptor);
+        counters->file_descriptors[i] = -1;
+    }
+#endif /* #ifdef __linux__ */
+
+    ++profile->searches;
+}
+
+void print_perf_profiles(const struct PerfProfile* profiles, const size_t thread_count) {
+    assert(profiles != nullptr);
+
+    // An event is only counted in total if every thread counted it.
+    struct PerfProfile total;
+    memset(&total, 0, sizeof(total));
+    for (size_t i = 0; i < PERF_EVENT_COUNT; ++i)
+        total.counted[i] = thread_count > 0;
+
+    for (size_t i = 0; i < thread_count; ++i) {
+        printf("\nThread %zu (%zu searches)\n", i, profiles[i].searches);
+        print_perf_profile(&profiles[i]);
+
+        total.nodes += profiles[i].nodes;
+        total.searches += profiles[i].searches;
+        for (size_t j = 0; j < PERF_EVENT_COUNT; ++j) {
+            total.counts[j] += profiles[i].counts[j];
+            total.counted[j] = total.counted[j] && profiles[i].counted[j];
+        }
+    }
+
+    printf("\nTotal (%zu searches)\n", total.searches);
+    print_perf_profile(&total);
+}
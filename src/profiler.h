@@ -0,0 +1,49 @@
+#ifndef WINDMOLEN_PROFILER_H_
+#define WINDMOLEN_PROFILER_H_
+
+
+#include <stddef.h>
+#include <stdint.h>
+
+
+
+// The hardware events that are counted while profiling searches.
+enum PerfEvent {
+    PERF_EVENT_CYCLES,
+    PERF_EVENT_INSTRUCTIONS,
+    PERF_EVENT_L1D_MISSES,
+    PERF_EVENT_LLC_MISSES,
+    PERF_EVENT_BRANCH_MISSES,
+    PERF_EVENT_DTLB_MISSES,
+    PERF_EVENT_COUNT
+};
+
+// The hardware counters of the calling thread. A counter that could not be opened, e.g. because the hardware or the
+// operating system does not support it, has a file descriptor of -1.
+struct PerfCounters {
+    int file_descriptors[PERF_EVENT_COUNT];
+};
+
+// The profile of a single search thread, accumulated over all of its profiled searches.
+struct PerfProfile {
+    uint64_t counts[PERF_EVENT_COUNT];
+    bool counted[PERF_EVENT_COUNT];
+    uint64_t nodes;
+    size_t searches;
+};
+
+
+// Opens and starts the hardware counters of the calling thread in `counters`. Only user space events are counted.
+void start_perf_counters(struct PerfCounters* counters);
+
+// Stops and closes the hardware counters in `counters`, which must have been started by the calling thread, and adds
+// their counts to `profile`.
+void stop_perf_counters(struct PerfCounters* counters, struct PerfProfile* profile);
+
+// Prints the instructions per cycle and the events per node of the first `thread_count` thread profiles in `profiles`
+// and of all of them together.
+void print_perf_profiles(const struct PerfProfile* profiles, size_t thread_count);
+
+
+
+#endif /* #ifndef WINDMOLEN_PROFILER_H_ */
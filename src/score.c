@@ -5,275 +5,148 @@
 
 
 
+// Shorthand for the packed scores in the tables below.
+#define S(middle_game, end_game) PACKED_SCORE(middle_game, end_game)
+
 // -2 because white and black pawns are the same, and the king has no value.
-[[maybe_unused]] static const Value piece_values_middle_game[PIECE_TYPE_COUNT - 2] = {82, 337, 365, 477, 1025};
-[[maybe_unused]] static const Value piece_values_end_game[PIECE_TYPE_COUNT - 2]    = {94, 281, 297, 512, 936};
+[[maybe_unused]] static const PackedScore piece_values[PIECE_TYPE_COUNT - 2] = {
+    S(82, 94), S(337, 281), S(365, 297), S(477, 512), S(1025, 936)
+};
 
 // clang-format off
-const Value piece_square_value_middle_game[PIECE_COUNT][SQUARE_COUNT] = {
+const PackedScore piece_square_score[PIECE_COUNT][SQUARE_COUNT] = {
     [PIECE_WHITE_PAWN] = {
-        82,   82,   82,   82,   82,   82,   82,   82,
-        47,   81,   62,   59,   67,  106,  120,   60,
-        56,   78,   78,   72,   85,   85,  115,   70,
-        55,   80,   77,   94,   99,   88,   92,   57,
-        68,   95,   88,  103,  105,   94,   99,   59,
-        76,   89,  108,  113,  147,  138,  107,   62,
-       180,  216,  143,  177,  150,  208,  116,   71,
-        82,   82,   82,   82,   82,   82,   82,   82
+        S(  82,  94), S(  82,  94), S(  82,  94), S(  82,  94), S(  82,  94), S(  82,  94), S(  82,  94), S(  82,  94),
+        S(  47, 107), S(  81, 102), S(  62, 102), S(  59, 104), S(  67, 107), S( 106,  94), S( 120,  96), S(  60,  87),
+        S(  56,  98), S(  78, 101), S(  78,  88), S(  72,  95), S(  85,  94), S(  85,  89), S( 115,  93), S(  70,  86),
+        S(  55, 107), S(  80, 103), S(  77,  91), S(  94,  87), S(  99,  87), S(  88,  86), S(  92,  97), S(  57,  93),
+        S(  68, 126), S(  95, 118), S(  88, 107), S( 103,  99), S( 105,  92), S(  94,  98), S(  99, 111), S(  59, 111),
+        S(  76, 188), S(  89, 194), S( 108, 179), S( 113, 161), S( 147, 150), S( 138, 147), S( 107, 176), S(  62, 178),
+        S( 180, 272), S( 216, 267), S( 143, 252), S( 177, 228), S( 150, 241), S( 208, 226), S( 116, 259), S(  71, 281),
+        S(  82,  94), S(  82,  94), S(  82,  94), S(  82,  94), S(  82,  94), S(  82,  94), S(  82,  94), S(  82,  94)
     },
 
     [PIECE_BLACK_PAWN] = {
-        82,   82,   82,   82,   82,   82,   82,   82,
-       180,  216,  143,  177,  150,  208,  116,   71,
-        76,   89,  108,  113,  147,  138,  107,   62,
-        68,   95,   88,  103,  105,   94,   99,   59,
-        55,   80,   77,   94,   99,   88,   92,   57,
-        56,   78,   78,   72,   85,   85,  115,   70,
-        47,   81,   62,   59,   67,  106,  120,   60,
-        82,   82,   82,   82,   82,   82,   82,   82
+        S(  82,  94), S(  82,  94), S(  82,  94), S(  82,  94), S(  82,  94), S(  82,  94), S(  82,  94), S(  82,  94),
+        S( 180, 272), S( 216, 267), S( 143, 252), S( 177, 228), S( 150, 241), S( 208, 226), S( 116, 259), S(  71, 281),
+        S(  76, 188), S(  89, 194), S( 108, 179), S( 113, 161), S( 147, 150), S( 138, 147), S( 107, 176), S(  62, 178),
+        S(  68, 126), S(  95, 118), S(  88, 107), S( 103,  99), S( 105,  92), S(  94,  98), S(  99, 111), S(  59, 111),
+        S(  55, 107), S(  80, 103), S(  77,  91), S(  94,  87), S(  99,  87), S(  88,  86), S(  92,  97), S(  57,  93),
+        S(  56,  98), S(  78, 101), S(  78,  88), S(  72,  95), S(  85,  94), S(  85,  89), S( 115,  93), S(  70,  86),
+        S(  47, 107), S(  81, 102), S(  62, 102), S(  59, 104), S(  67, 107), S( 106,  94), S( 120,  96), S(  60,  87),
+        S(  82,  94), S(  82,  94), S(  82,  94), S(  82,  94), S(  82,  94), S(  82,  94), S(  82,  94), S(  82,  94)
     },
 
     [PIECE_WHITE_KNIGHT] = {
-       232,  316,  279,  304,  320,  309,  318,  314,
-       308,  284,  325,  334,  336,  355,  323,  318,
-       314,  328,  349,  347,  356,  354,  362,  321,
-       324,  341,  353,  350,  365,  356,  358,  329,
-       328,  354,  356,  390,  374,  406,  355,  359,
-       290,  397,  374,  402,  421,  466,  410,  381,
-       264,  296,  409,  373,  360,  399,  344,  320,
-       170,  248,  303,  288,  398,  240,  322,  230
+        S( 232, 252), S( 316, 230), S( 279, 258), S( 304, 266), S( 320, 259), S( 309, 263), S( 318, 231), S( 314, 217),
+        S( 308, 239), S( 284, 261), S( 325, 271), S( 334, 276), S( 336, 279), S( 355, 261), S( 323, 258), S( 318, 237),
+        S( 314, 258), S( 328, 278), S( 349, 280), S( 347, 296), S( 356, 291), S( 354, 278), S( 362, 261), S( 321, 259),
+        S( 324, 263), S( 341, 275), S( 353, 297), S( 350, 306), S( 365, 297), S( 356, 298), S( 358, 285), S( 329, 263),
+        S( 328, 264), S( 354, 284), S( 356, 303), S( 390, 303), S( 374, 303), S( 406, 292), S( 355, 289), S( 359, 263),
+        S( 290, 257), S( 397, 261), S( 374, 291), S( 402, 290), S( 421, 280), S( 466, 272), S( 410, 262), S( 381, 240),
+        S( 264, 256), S( 296, 273), S( 409, 256), S( 373, 279), S( 360, 272), S( 399, 256), S( 344, 257), S( 320, 229),
+        S( 170, 223), S( 248, 243), S( 303, 268), S( 288, 253), S( 398, 250), S( 240, 254), S( 322, 218), S( 230, 182)
     },
 
     [PIECE_BLACK_KNIGHT] = {
-       170,  248,  303,  288,  398,  240,  322,  230,
-       264,  296,  409,  373,  360,  399,  344,  320,
-       290,  397,  374,  402,  421,  466,  410,  381,
-       328,  354,  356,  390,  374,  406,  355,  359,
-       324,  341,  353,  350,  365,  356,  358,  329,
-       314,  328,  349,  347,  356,  354,  362,  321,
-       308,  284,  325,  334,  336,  355,  323,  318,
-       232,  316,  279,  304,  320,  309,  318,  314
+        S( 170, 223), S( 248, 243), S( 303, 268), S( 288, 253), S( 398, 250), S( 240, 254), S( 322, 218), S( 230, 182),
+        S( 264, 256), S( 296, 273), S( 409, 256), S( 373, 279), S( 360, 272), S( 399, 256), S( 344, 257), S( 320, 229),
+        S( 290, 257), S( 397, 261), S( 374, 291), S( 402, 290), S( 421, 280), S( 466, 272), S( 410, 262), S( 381, 240),
+        S( 328, 264), S( 354, 284), S( 356, 303), S( 390, 303), S( 374, 303), S( 406, 292), S( 355, 289), S( 359, 263),
+        S( 324, 263), S( 341, 275), S( 353, 297), S( 350, 306), S( 365, 297), S( 356, 298), S( 358, 285), S( 329, 263),
+        S( 314, 258), S( 328, 278), S( 349, 280), S( 347, 296), S( 356, 291), S( 354, 278), S( 362, 261), S( 321, 259),
+        S( 308, 239), S( 284, 261), S( 325, 271), S( 334, 276), S( 336, 279), S( 355, 261), S( 323, 258), S( 318, 237),
+        S( 232, 252), S( 316, 230), S( 279, 258), S( 304, 266), S( 320, 259), S( 309, 263), S( 318, 231), S( 314, 217)
     },
 
     [PIECE_WHITE_BISHOP] = {
-       332,  362,  351,  344,  352,  353,  326,  344,
-       369,  380,  381,  365,  372,  386,  398,  366,
-       365,  380,  380,  380,  379,  392,  383,  375,
-       359,  378,  378,  391,  399,  377,  375,  369,
-       361,  370,  384,  415,  402,  402,  372,  363,
-       349,  402,  408,  405,  400,  415,  402,  363,
-       339,  381,  347,  352,  395,  424,  383,  318,
-       336,  369,  283,  328,  340,  323,  372,  357
+        S( 332, 274), S( 362, 288), S( 351, 274), S( 344, 292), S( 352, 288), S( 353, 281), S( 326, 292), S( 344, 280),
+        S( 369, 283), S( 380, 279), S( 381, 290), S( 365, 296), S( 372, 301), S( 386, 288), S( 398, 282), S( 366, 270),
+        S( 365, 285), S( 380, 294), S( 380, 305), S( 380, 307), S( 379, 310), S( 392, 300), S( 383, 290), S( 375, 282),
+        S( 359, 291), S( 378, 300), S( 378, 310), S( 391, 316), S( 399, 304), S( 377, 307), S( 375, 294), S( 369, 288),
+        S( 361, 294), S( 370, 306), S( 384, 309), S( 415, 306), S( 402, 311), S( 402, 307), S( 372, 300), S( 363, 299),
+        S( 349, 299), S( 402, 289), S( 408, 297), S( 405, 296), S( 400, 295), S( 415, 303), S( 402, 297), S( 363, 301),
+        S( 339, 289), S( 381, 293), S( 347, 304), S( 352, 285), S( 395, 294), S( 424, 284), S( 383, 293), S( 318, 283),
+        S( 336, 283), S( 369, 276), S( 283, 286), S( 328, 289), S( 340, 290), S( 323, 288), S( 372, 280), S( 357, 273)
     },
 
     [PIECE_BLACK_BISHOP] = {
-       336,  369,  283,  328,  340,  323,  372,  357,
-       339,  381,  347,  352,  395,  424,  383,  318,
-       349,  402,  408,  405,  400,  415,  402,  363,
-       361,  370,  384,  415,  402,  402,  372,  363,
-       359,  378,  378,  391,  399,  377,  375,  369,
-       365,  380,  380,  380,  379,  392,  383,  375,
-       369,  380,  381,  365,  372,  386,  398,  366,
-       332,  362,  351,  344,  352,  353,  326,  344
+        S( 336, 283), S( 369, 276), S( 283, 286), S( 328, 289), S( 340, 290), S( 323, 288), S( 372, 280), S( 357, 273),
+        S( 339, 289), S( 381, 293), S( 347, 304), S( 352, 285), S( 395, 294), S( 424, 284), S( 383, 293), S( 318, 283),
+        S( 349, 299), S( 402, 289), S( 408, 297), S( 405, 296), S( 400, 295), S( 415, 303), S( 402, 297), S( 363, 301),
+        S( 361, 294), S( 370, 306), S( 384, 309), S( 415, 306), S( 402, 311), S( 402, 307), S( 372, 300), S( 363, 299),
+        S( 359, 291), S( 378, 300), S( 378, 310), S( 391, 316), S( 399, 304), S( 377, 307), S( 375, 294), S( 369, 288),
+        S( 365, 285), S( 380, 294), S( 380, 305), S( 380, 307), S( 379, 310), S( 392, 300), S( 383, 290), S( 375, 282),
+        S( 369, 283), S( 380, 279), S( 381, 290), S( 365, 296), S( 372, 301), S( 386, 288), S( 398, 282), S( 366, 270),
+        S( 332, 274), S( 362, 288), S( 351, 274), S( 344, 292), S( 352, 288), S( 353, 281), S( 326, 292), S( 344, 280)
     },
 
     [PIECE_WHITE_ROOK] = {
-       458,  464,  478,  494,  493,  484,  440,  451,
-       433,  461,  457,  468,  476,  488,  471,  406,
-       432,  452,  461,  460,  480,  477,  472,  444,
-       441,  451,  465,  476,  486,  470,  483,  454,
-       453,  466,  484,  503,  501,  512,  469,  457,
-       472,  496,  503,  513,  494,  522,  538,  493,
-       504,  509,  535,  539,  557,  544,  503,  521,
-       509,  519,  509,  528,  540,  486,  508,  520
+        S( 458, 503), S( 464, 514), S( 478, 515), S( 494, 511), S( 493, 507), S( 484, 499), S( 440, 516), S( 451, 492),
+        S( 433, 506), S( 461, 506), S( 457, 512), S( 468, 514), S( 476, 503), S( 488, 503), S( 471, 501), S( 406, 509),
+        S( 432, 508), S( 452, 512), S( 461, 507), S( 460, 511), S( 480, 505), S( 477, 500), S( 472, 504), S( 444, 496),
+        S( 441, 515), S( 451, 517), S( 465, 520), S( 476, 516), S( 486, 507), S( 470, 506), S( 483, 504), S( 454, 501),
+        S( 453, 516), S( 466, 515), S( 484, 525), S( 503, 513), S( 501, 514), S( 512, 513), S( 469, 511), S( 457, 514),
+        S( 472, 519), S( 496, 519), S( 503, 519), S( 513, 517), S( 494, 516), S( 522, 509), S( 538, 507), S( 493, 509),
+        S( 504, 523), S( 509, 525), S( 535, 525), S( 539, 523), S( 557, 509), S( 544, 515), S( 503, 520), S( 521, 515),
+        S( 509, 525), S( 519, 522), S( 509, 530), S( 528, 527), S( 540, 524), S( 486, 524), S( 508, 520), S( 520, 517)
     },
 
     [PIECE_BLACK_ROOK] = {
-       509,  519,  509,  528,  540,  486,  508,  520,
-       504,  509,  535,  539,  557,  544,  503,  521,
-       472,  496,  503,  513,  494,  522,  538,  493,
-       453,  466,  484,  503,  501,  512,  469,  457,
-       441,  451,  465,  476,  486,  470,  483,  454,
-       432,  452,  461,  460,  480,  477,  472,  444,
-       433,  461,  457,  468,  476,  488,  471,  406,
-       458,  464,  478,  494,  493,  484,  440,  451
+        S( 509, 525), S( 519, 522), S( 509, 530), S( 528, 527), S( 540, 524), S( 486, 524), S( 508, 520), S( 520, 517),
+        S( 504, 523), S( 509, 525), S( 535, 525), S( 539, 523), S( 557, 509), S( 544, 515), S( 503, 520), S( 521, 515),
+        S( 472, 519), S( 496, 519), S( 503, 519), S( 513, 517), S( 494, 516), S( 522, 509), S( 538, 507), S( 493, 509),
+        S( 453, 516), S( 466, 515), S( 484, 525), S( 503, 513), S( 501, 514), S( 512, 513), S( 469, 511), S( 457, 514),
+        S( 441, 515), S( 451, 517), S( 465, 520), S( 476, 516), S( 486, 507), S( 470, 506), S( 483, 504), S( 454, 501),
+        S( 432, 508), S( 452, 512), S( 461, 507), S( 460, 511), S( 480, 505), S( 477, 500), S( 472, 504), S( 444, 496),
+        S( 433, 506), S( 461, 506), S( 457, 512), S( 468, 514), S( 476, 503), S( 488, 503), S( 471, 501), S( 406, 509),
+        S( 458, 503), S( 464, 514), S( 478, 515), S( 494, 511), S( 493, 507), S( 484, 499), S( 440, 516), S( 451, 492)
     },
 
     [PIECE_WHITE_QUEEN] = {
-      1024, 1007, 1016, 1035, 1010, 1000,  994,  975,
-       990, 1017, 1036, 1027, 1033, 1040, 1022, 1026,
-      1011, 1027, 1014, 1023, 1020, 1027, 1039, 1030,
-      1016,  999, 1016, 1015, 1023, 1021, 1028, 1022,
-       998,  998, 1009, 1009, 1024, 1042, 1023, 1026,
-      1012, 1008, 1032, 1033, 1054, 1081, 1072, 1082,
-      1001,  986, 1020, 1026, 1009, 1082, 1053, 1079,
-       997, 1025, 1054, 1037, 1084, 1069, 1068, 1070
+        S(1024, 903), S(1007, 908), S(1016, 914), S(1035, 893), S(1010, 931), S(1000, 904), S( 994, 916), S( 975, 895),
+        S( 990, 914), S(1017, 913), S(1036, 906), S(1027, 920), S(1033, 920), S(1040, 913), S(1022, 900), S(1026, 904),
+        S(1011, 920), S(1027, 909), S(1014, 951), S(1023, 942), S(1020, 945), S(1027, 953), S(1039, 946), S(1030, 941),
+        S(1016, 918), S( 999, 964), S(1016, 955), S(1015, 983), S(1023, 967), S(1021, 970), S(1028, 975), S(1022, 959),
+        S( 998, 939), S( 998, 958), S(1009, 960), S(1009, 981), S(1024, 993), S(1042, 976), S(1023, 993), S(1026, 972),
+        S(1012, 916), S(1008, 942), S(1032, 945), S(1033, 985), S(1054, 983), S(1081, 971), S(1072, 955), S(1082, 945),
+        S(1001, 919), S( 986, 956), S(1020, 968), S(1026, 977), S(1009, 994), S(1082, 961), S(1053, 966), S(1079, 936),
+        S( 997, 927), S(1025, 958), S(1054, 958), S(1037, 963), S(1084, 963), S(1069, 955), S(1068, 946), S(1070, 956)
     },
 
     [PIECE_BLACK_QUEEN] = {
-       997, 1025, 1054, 1037, 1084, 1069, 1068, 1070,
-      1001,  986, 1020, 1026, 1009, 1082, 1053, 1079,
-      1012, 1008, 1032, 1033, 1054, 1081, 1072, 1082,
-       998,  998, 1009, 1009, 1024, 1042, 1023, 1026,
-      1016,  999, 1016, 1015, 1023, 1021, 1028, 1022,
-      1011, 1027, 1014, 1023, 1020, 1027, 1039, 1030,
-       990, 1017, 1036, 1027, 1033, 1040, 1022, 1026,
-      1024, 1007, 1016, 1035, 1010, 1000,  994,  975
+        S( 997, 927), S(1025, 958), S(1054, 958), S(1037, 963), S(1084, 963), S(1069, 955), S(1068, 946), S(1070, 956),
+        S(1001, 919), S( 986, 956), S(1020, 968), S(1026, 977), S(1009, 994), S(1082, 961), S(1053, 966), S(1079, 936),
+        S(1012, 916), S(1008, 942), S(1032, 945), S(1033, 985), S(1054, 983), S(1081, 971), S(1072, 955), S(1082, 945),
+        S( 998, 939), S( 998, 958), S(1009, 960), S(1009, 981), S(1024, 993), S(1042, 976), S(1023, 993), S(1026, 972),
+        S(1016, 918), S( 999, 964), S(1016, 955), S(1015, 983), S(1023, 967), S(1021, 970), S(1028, 975), S(1022, 959),
+        S(1011, 920), S(1027, 909), S(1014, 951), S(1023, 942), S(1020, 945), S(1027, 953), S(1039, 946), S(1030, 941),
+        S( 990, 914), S(1017, 913), S(1036, 906), S(1027, 920), S(1033, 920), S(1040, 913), S(1022, 900), S(1026, 904),
+        S(1024, 903), S(1007, 908), S(1016, 914), S(1035, 893), S(1010, 931), S(1000, 904), S( 994, 916), S( 975, 895)
     },
 
     [PIECE_WHITE_KING] = {
-       -15,   36,   12,  -54,    8,  -28,   24,   14,
-         1,    7,   -8,  -64,  -43,  -16,    9,    8,
-       -14,  -14,  -22,  -46,  -44,  -30,  -15,  -27,
-       -49,   -1,  -27,  -39,  -46,  -44,  -33,  -51,
-       -17,  -20,  -12,  -27,  -30,  -25,  -14,  -36,
-        -9,   24,    2,  -16,  -20,    6,   22,  -22,
-        29,   -1,  -20,   -7,   -8,   -4,  -38,  -29,
-       -65,   23,   16,  -15,  -56,  -34,    2,   13
+        S( -15, -53), S(  36, -34), S(  12, -21), S( -54, -11), S(   8, -28), S( -28, -14), S(  24, -24), S(  14, -43),
+        S(   1, -27), S(   7, -11), S(  -8,   4), S( -64,  13), S( -43,  14), S( -16,   4), S(   9,  -5), S(   8, -17),
+        S( -14, -19), S( -14,  -3), S( -22,  11), S( -46,  21), S( -44,  23), S( -30,  16), S( -15,   7), S( -27,  -9),
+        S( -49, -18), S(  -1,  -4), S( -27,  21), S( -39,  24), S( -46,  27), S( -44,  23), S( -33,   9), S( -51, -11),
+        S( -17,  -8), S( -20,  22), S( -12,  24), S( -27,  27), S( -30,  26), S( -25,  33), S( -14,  26), S( -36,   3),
+        S(  -9,  10), S(  24,  17), S(   2,  23), S( -16,  15), S( -20,  20), S(   6,  45), S(  22,  44), S( -22,  13),
+        S(  29, -12), S(  -1,  17), S( -20,  14), S(  -7,  17), S(  -8,  17), S(  -4,  38), S( -38,  23), S( -29,  11),
+        S( -65, -74), S(  23, -35), S(  16, -18), S( -15, -18), S( -56, -11), S( -34,  15), S(   2,   4), S(  13, -17)
     },
 
     [PIECE_BLACK_KING] = {
-       -65,   23,   16,  -15,  -56,  -34,    2,   13,
-        29,   -1,  -20,   -7,   -8,   -4,  -38,  -29,
-        -9,   24,    2,  -16,  -20,    6,   22,  -22,
-       -17,  -20,  -12,  -27,  -30,  -25,  -14,  -36,
-       -49,   -1,  -27,  -39,  -46,  -44,  -33,  -51,
-       -14,  -14,  -22,  -46,  -44,  -30,  -15,  -27,
-         1,    7,   -8,  -64,  -43,  -16,    9,    8,
-       -15,   36,   12,  -54,    8,  -28,   24,   14
-    }
-};
-const Value piece_square_value_end_game[PIECE_COUNT][SQUARE_COUNT] = {
-    [PIECE_WHITE_PAWN] = {
-        94,  94,  94,  94,  94,  94,  94,  94,
-       107, 102, 102, 104, 107,  94,  96,  87,
-        98, 101,  88,  95,  94,  89,  93,  86,
-       107, 103,  91,  87,  87,  86,  97,  93,
-       126, 118, 107,  99,  92,  98, 111, 111,
-       188, 194, 179, 161, 150, 147, 176, 178,
-       272, 267, 252, 228, 241, 226, 259, 281,
-        94,  94,  94,  94,  94,  94,  94,  94
-    },
-
-    [PIECE_BLACK_PAWN] = {
-        94,  94,  94,  94,  94,  94,  94,  94,
-       272, 267, 252, 228, 241, 226, 259, 281,
-       188, 194, 179, 161, 150, 147, 176, 178,
-       126, 118, 107,  99,  92,  98, 111, 111,
-       107, 103,  91,  87,  87,  86,  97,  93,
-        98, 101,  88,  95,  94,  89,  93,  86,
-       107, 102, 102, 104, 107,  94,  96,  87,
-        94,  94,  94,  94,  94,  94,  94,  94
-    },
-
-    [PIECE_WHITE_KNIGHT] = {
-       252, 230, 258, 266, 259, 263, 231, 217,
-       239, 261, 271, 276, 279, 261, 258, 237,
-       258, 278, 280, 296, 291, 278, 261, 259,
-       263, 275, 297, 306, 297, 298, 285, 263,
-       264, 284, 303, 303, 303, 292, 289, 263,
-       257, 261, 291, 290, 280, 272, 262, 240,
-       256, 273, 256, 279, 272, 256, 257, 229,
-       223, 243, 268, 253, 250, 254, 218, 182
-    },
-
-    [PIECE_BLACK_KNIGHT] = {
-       223, 243, 268, 253, 250, 254, 218, 182,
-       256, 273, 256, 279, 272, 256, 257, 229,
-       257, 261, 291, 290, 280, 272, 262, 240,
-       264, 284, 303, 303, 303, 292, 289, 263,
-       263, 275, 297, 306, 297, 298, 285, 263,
-       258, 278, 280, 296, 291, 278, 261, 259,
-       239, 261, 271, 276, 279, 261, 258, 237,
-       252, 230, 258, 266, 259, 263, 231, 217
-    },
-
-    [PIECE_WHITE_BISHOP] = {
-       274, 288, 274, 292, 288, 281, 292, 280,
-       283, 279, 290, 296, 301, 288, 282, 270,
-       285, 294, 305, 307, 310, 300, 290, 282,
-       291, 300, 310, 316, 304, 307, 294, 288,
-       294, 306, 309, 306, 311, 307, 300, 299,
-       299, 289, 297, 296, 295, 303, 297, 301,
-       289, 293, 304, 285, 294, 284, 293, 283,
-       283, 276, 286, 289, 290, 288, 280, 273
-    },
-
-    [PIECE_BLACK_BISHOP] = {
-       283, 276, 286, 289, 290, 288, 280, 273,
-       289, 293, 304, 285, 294, 284, 293, 283,
-       299, 289, 297, 296, 295, 303, 297, 301,
-       294, 306, 309, 306, 311, 307, 300, 299,
-       291, 300, 310, 316, 304, 307, 294, 288,
-       285, 294, 305, 307, 310, 300, 290, 282,
-       283, 279, 290, 296, 301, 288, 282, 270,
-       274, 288, 274, 292, 288, 281, 292, 280
-    },
-
-    [PIECE_WHITE_ROOK] = {
-       503, 514, 515, 511, 507, 499, 516, 492,
-       506, 506, 512, 514, 503, 503, 501, 509,
-       508, 512, 507, 511, 505, 500, 504, 496,
-       515, 517, 520, 516, 507, 506, 504, 501,
-       516, 515, 525, 513, 514, 513, 511, 514,
-       519, 519, 519, 517, 516, 509, 507, 509,
-       523, 525, 525, 523, 509, 515, 520, 515,
-       525, 522, 530, 527, 524, 524, 520, 517
-    },
-
-    [PIECE_BLACK_ROOK] = {
-       525, 522, 530, 527, 524, 524, 520, 517,
-       523, 525, 525, 523, 509, 515, 520, 515,
-       519, 519, 519, 517, 516, 509, 507, 509,
-       516, 515, 525, 513, 514, 513, 511, 514,
-       515, 517, 520, 516, 507, 506, 504, 501,
-       508, 512, 507, 511, 505, 500, 504, 496,
-       506, 506, 512, 514, 503, 503, 501, 509,
-       503, 514, 515, 511, 507, 499, 516, 492
-    },
-
-    [PIECE_WHITE_QUEEN] = {
-       903, 908, 914, 893, 931, 904, 916, 895,
-       914, 913, 906, 920, 920, 913, 900, 904,
-       920, 909, 951, 942, 945, 953, 946, 941,
-       918, 964, 955, 983, 967, 970, 975, 959,
-       939, 958, 960, 981, 993, 976, 993, 972,
-       916, 942, 945, 985, 983, 971, 955, 945,
-       919, 956, 968, 977, 994, 961, 966, 936,
-       927, 958, 958, 963, 963, 955, 946, 956
-    },
-
-    [PIECE_BLACK_QUEEN] = {
-       927, 958, 958, 963, 963, 955, 946, 956,
-       919, 956, 968, 977, 994, 961, 966, 936,
-       916, 942, 945, 985, 983, 971, 955, 945,
-       939, 958, 960, 981, 993, 976, 993, 972,
-       918, 964, 955, 983, 967, 970, 975, 959,
-       920, 909, 951, 942, 945, 953, 946, 941,
-       914, 913, 906, 920, 920, 913, 900, 904,
-       903, 908, 914, 893, 931, 904, 916, 895
-    },
-
-    [PIECE_WHITE_KING] = {
-       -53, -34, -21, -11, -28, -14, -24, -43,
-       -27, -11,   4,  13,  14,   4,  -5, -17,
-       -19,  -3,  11,  21,  23,  16,   7,  -9,
-       -18,  -4,  21,  24,  27,  23,   9, -11,
-        -8,  22,  24,  27,  26,  33,  26,   3,
-        10,  17,  23,  15,  20,  45,  44,  13,
-       -12,  17,  14,  17,  17,  38,  23,  11,
-       -74, -35, -18, -18, -11,  15,   4, -17
-    },
-
-    [PIECE_BLACK_KING] = {
-       -74, -35, -18, -18, -11,  15,   4, -17,
-       -12,  17,  14,  17,  17,  38,  23,  11,
-        10,  17,  23,  15,  20,  45,  44,  13,
-        -8,  22,  24,  27,  26,  33,  26,   3,
-       -18,  -4,  21,  24,  27,  23,   9, -11,
-       -19,  -3,  11,  21,  23,  16,   7,  -9,
-       -27, -11,   4,  13,  14,   4,  -5, -17,
-       -53, -34, -21, -11, -28, -14, -24, -43
+        S( -65, -74), S(  23, -35), S(  16, -18), S( -15, -18), S( -56, -11), S( -34,  15), S(   2,   4), S(  13, -17),
+        S(  29, -12), S(  -1,  17), S( -20,  14), S(  -7,  17), S(  -8,  17), S(  -4,  38), S( -38,  23), S( -29,  11),
+        S(  -9,  10), S(  24,  17), S(   2,  23), S( -16,  15), S( -20,  20), S(   6,  45), S(  22,  44), S( -22,  13),
+        S( -17,  -8), S( -20,  22), S( -12,  24), S( -27,  27), S( -30,  26), S( -25,  33), S( -14,  26), S( -36,   3),
+        S( -49, -18), S(  -1,  -4), S( -27,  21), S( -39,  24), S( -46,  27), S( -44,  23), S( -33,   9), S( -51, -11),
+        S( -14, -19), S( -14,  -3), S( -22,  11), S( -46,  21), S( -44,  23), S( -30,  16), S( -15,   7), S( -27,  -9),
+        S(   1, -27), S(   7, -11), S(  -8,   4), S( -64,  13), S( -43,  14), S( -16,   4), S(   9,  -5), S(   8, -17),
+        S( -15, -53), S(  36, -34), S(  12, -21), S( -54, -11), S(   8, -28), S( -28, -14), S(  24, -24), S(  14, -43)
     }
 };
 // clang-format on
+
+#undef S
@@ -15,6 +15,13 @@
 typedef int16_t Score;  // The Score type is used to store and interpret scores.
 typedef int Value;      // The Value type is used for calculation of scores.
 
+// A packed score holds a middle game value in its lower 16 bits and an end game value in its upper 16 bits, so both can
+// be updated with a single addition or subtraction.
+typedef int32_t PackedScore;
+
+// Packs `middle_game` and `end_game` into a packed score. This is a macro so it can be used in constant initializers.
+#define PACKED_SCORE(middle_game, end_game) ((PackedScore)((end_game) * (1 << 16) + (middle_game)))
+
 
 static constexpr Score DRAW_SCORE = 0;
 static constexpr Score MATE_SCORE = INT16_MAX;
@@ -26,6 +33,9 @@ static constexpr Value MATE_VALUE = MATE_SCORE;
 static constexpr Value MAX_VALUE  = MAX_SCORE;
 static constexpr Value MIN_VALUE  = MIN_SCORE;
 
+// The value of a tablebase win, which lies between the values of known wins and the values of mates.
+static constexpr Value TABLEBASE_WIN_VALUE = MATE_VALUE - 2 * (Value)MAX_SEARCH_DEPTH;
+
 
 // clang-format off
 static constexpr int game_phase_increment[PIECE_TYPE_COUNT] = {
@@ -38,9 +48,12 @@ static constexpr int game_phase_increment[PIECE_TYPE_COUNT] = {
 };
 // clang-format on
 
+// The game phase ranges from 0 (only kings and pawns) to MAX_GAME_PHASE (all pieces on the board). It can exceed
+// MAX_GAME_PHASE after promotions.
+static constexpr int MAX_GAME_PHASE = 24;
 
-extern const Value piece_square_value_middle_game[PIECE_COUNT][SQUARE_COUNT];
-extern const Value piece_square_value_end_game[PIECE_COUNT][SQUARE_COUNT];
+
+extern const PackedScore piece_square_score[PIECE_COUNT][SQUARE_COUNT];
 
 
 // Returns whether `score` is valid.
@@ -57,6 +70,25 @@ static INLINE bool is_valid_value(const Value value) {
 }
 
 
+// Returns the middle game value of `score`.
+static INLINE Value middle_game_value(const PackedScore score) {
+    return (int16_t)(uint16_t)(uint32_t)score;
+}
+
+// Returns the end game value of `score`. The rounding makes up for a borrow by a negative middle game value.
+static INLINE Value end_game_value(const PackedScore score) {
+    return (int16_t)(uint16_t)(((uint32_t)score + 0x8000U) >> 16);
+}
+
+// Blends the middle game and end game values of `score` according to `game_phase`.
+static INLINE Value taper_score(const PackedScore score, const int game_phase) {
+    assert(game_phase >= 0 && game_phase <= MAX_GAME_PHASE);
+
+    return (middle_game_value(score) * game_phase + end_game_value(score) * (MAX_GAME_PHASE - game_phase))
+         / MAX_GAME_PHASE;
+}
+
+
 // Computes the value belonging to a mate in `ply`.
 static INLINE Value mate_value(const size_t ply) {
     assert(ply <= MAX_SEARCH_DEPTH);
@@ -4,14 +4,21 @@
 #include <stdatomic.h>
 #include <stddef.h>
 #include <stdint.h>
+#include <stdlib.h>
 #include <string.h>
+#include <threads.h>
+#include <time.h>
 
 #include "constants.h"
+#include "eval_cache.h"
 #include "evaluation.h"
+#include "mate_search.h"
+#include "material.h"
 #include "move.h"
 #include "move_generation.h"
 #include "move_picker.h"
 #include "position.h"
+#include "syzygy.h"
 #include "thread.h"
 #include "time_manager.h"
 #include "uci.h"
@@ -19,11 +26,14 @@
 
 
 
-// Stops the search if the search time is exceeded.s
+// Stops the search if the search time is exceeded. While pondering, the search time is never exceeded.
 static INLINE void stop_if_time_exceeded(struct Searcher* searcher) {
     assert(searcher != nullptr);
     assert(is_main_thread(searcher));
 
+    if (atomic_load(&searcher->thread_pool->pondering))
+        return;
+
     if (get_time_us() >= searcher->thread_pool->time_manager->cutoff_time)
         atomic_store(&searcher->thread_pool->stop_search, true);
 }
@@ -44,16 +54,29 @@ static const struct Searcher* best_searcher(const struct ThreadPool* thread_pool
 }
 
 
-static Value quiescence_search(struct Searcher* searcher, struct Position* position, Value alpha, const Value beta) {
+static Value quiescence_search(struct Searcher* searcher, struct Position* position, Value alpha, const Value beta,
+                               const size_t ply) {
     assert(searcher != nullptr);
     assert(position != nullptr);
     assert(alpha <= beta);
 
-    atomic_fetch_add(&searcher->nodes_searched, 1);
+    // The parent records this node even if the search stops here, so its cutoff index is reset first.
+    SEARCH_TRACE_ENTER(searcher, ply);
 
-    // We can assume that their is always at least one move that can match or beat the lower bound.
-    const Value static_evaluation = evaluate_position(position);
-    Value best_value              = (position->side_to_move == COLOR_WHITE) ? static_evaluation : -static_evaluation;
+    if (!count_node(searcher))
+        return DRAW_VALUE;
+
+    SEARCH_STATISTIC_ADD(searcher, quiescence_nodes, 1);
+
+    // We can assume that their is always at least one move that can match or beat the lower bound. Transpositions
+    // within the quiescence search are common, so the static evaluation is cached. Once there is a transposition table
+    // that stores the static evaluation, it should be consulted before the eval cache.
+    Value best_value;
+    if (!probe_eval_cache(&searcher->eval_cache, zobrist_key(position), &best_value)) {
+        best_value = evaluate_position(&searcher->evaluator, &searcher->pawn_table, &searcher->material_table,
+                                       position);
+        store_eval_cache(&searcher->eval_cache, zobrist_key(position), best_value);
+    }
 
     if (best_value >= beta)
         return best_value;
@@ -73,12 +96,16 @@ static Value quiescence_search(struct Searcher* searcher, struct Position* posit
 
         do_move(position, &info, move);
 
-        const Value value = -quiescence_search(searcher, position, -beta, -alpha);
+        const Value value = -quiescence_search(searcher, position, -beta, -alpha, ply + 1);
 
         undo_move(position, move);
 
-        if (value >= beta)
+        SEARCH_TRACE_NODE(searcher, move, i, ply + 1, 0, -beta, -alpha, -value);
+
+        if (value >= beta) {
+            SEARCH_TRACE_CUTOFF(searcher, ply, i);
             return value;
+        }
 
         if (value > best_value)
             best_value = value;
@@ -97,10 +124,54 @@ static Value alphabeta(struct Searcher* searcher, struct Position* position, Val
     assert(position != nullptr);
     assert(alpha <= beta);
 
-    atomic_fetch_add(&searcher->nodes_searched, 1);
+    SEARCH_TRACE_ENTER(searcher, ply);
+
+    if (!count_node(searcher))
+        return DRAW_VALUE;
+
+    // If neither side can mate, there is nothing left to search.
+    if (probe_material_table(&searcher->material_table, position)->draw) {
+        SEARCH_STATISTIC_ADD(searcher, material_draw_cutoffs, 1);
+        return DRAW_VALUE;
+    }
 
     if (depth == 0)
-        return quiescence_search(searcher, position, alpha, beta);
+        return quiescence_search(searcher, position, alpha, beta, ply);
+
+    // Once few enough pieces are left, probe the tablebases right after a capture or pawn move, as the tables do not
+    // know the 50 move counter. Positions with the largest number of pieces are only probed at a sufficient depth, as
+    // those probes are the most expensive. Cursed wins and blessed losses are draws under the 50 move rule.
+    Value best_value                 = MIN_VALUE;
+    Value max_value                  = MAX_VALUE;
+    const size_t tablebase_piece_max = searcher->thread_pool->tablebase_probe_limit;
+    const size_t piece_count         = (size_t)popcount64(position->total_occupancy);
+    if (piece_count <= tablebase_piece_max && position->info->halfmove_clock == 0
+        && position->info->castling_rights == CASTLE_NONE
+        && (piece_count < tablebase_piece_max || depth >= searcher->thread_pool->options->syzygy_probe_depth)) {
+        enum WdlScore wdl;
+        if (probe_wdl(position, &wdl)) {
+            atomic_fetch_add(&searcher->tablebase_hits, 1);
+
+            // A tablebase win is a lower bound, as the search might still find a mate, and a loss an upper bound.
+            if (wdl == WDL_WIN) {
+                const Value value = TABLEBASE_WIN_VALUE - (Value)ply;
+                if (value >= beta)
+                    return value;
+
+                best_value = value;
+                if (value > alpha)
+                    alpha = value;
+            } else if (wdl == WDL_LOSS) {
+                const Value value = -TABLEBASE_WIN_VALUE + (Value)ply;
+                if (value <= alpha)
+                    return value;
+
+                max_value = value;
+            } else {
+                return DRAW_VALUE;
+            }
+        }
+    }
 
     if (is_main_thread(searcher) && !searcher->thread_pool->search_arguments->infinite_search)
         stop_if_time_exceeded(searcher);
@@ -125,8 +196,6 @@ static Value alphabeta(struct Searcher* searcher, struct Position* position, Val
     int8_t move_values[MAX_MOVES];
     compute_mvv_lva_values(position, move_list, move_count, move_values);
 
-    Value best_value = MIN_VALUE;
-
     struct PositionInfo info;
     for (size_t i = 0; i < move_count; ++i) {
         const Move move = pick_move(move_list, move_values, move_count, i);
@@ -137,10 +206,17 @@ static Value alphabeta(struct Searcher* searcher, struct Position* position, Val
 
         undo_move(position, move);
 
+        SEARCH_TRACE_NODE(searcher, move, i, ply + 1, depth - 1, -beta, -alpha, -value);
+
         if (value > best_value) {
             // Cut node.
-            if (value >= beta)
+            if (value >= beta) {
+                SEARCH_STATISTIC_ADD(searcher, cutoffs, 1);
+                SEARCH_STATISTIC_ADD(searcher, first_move_cutoffs, i == 0);
+                SEARCH_STATISTIC_ADD(searcher, cutoff_index_sum, i);
+                SEARCH_TRACE_CUTOFF(searcher, ply, i);
                 return value;
+            }
 
             best_value = value;
 
@@ -156,81 +232,176 @@ static Value alphabeta(struct Searcher* searcher, struct Position* position, Val
             searcher->principal_variation_length[ply] = searcher->principal_variation_length[ply + 1] + 1;
         }
 
+        // Any searcher can notice that the search is stopped, as the search may also be stopped because the node
+        // limit has been reached.
         if (atomic_load(&searcher->thread_pool->stop_search)) {
-            if (is_main_thread(searcher))
-                atomic_store(&searcher->thread_pool->search_aborted, true);
+            atomic_store(&searcher->thread_pool->search_aborted, true);
             break;
         }
     }
 
-    return best_value;
+    return (best_value > max_value) ? max_value : best_value;
 }
 
-// Performs search on root nodes.
-static Value root_search(struct Searcher* searcher, const size_t depth, size_t* best_move_index) {
+// Performs search on the root moves of `searcher` from `pv_index` onwards, as the root moves before it already belong to
+// better lines. The result of every root move that raises alpha is stored in that root move. Returns the index of the
+// best root move, or SIZE_MAX if not a single root move has been searched completely.
+static size_t root_search(struct Searcher* searcher, const size_t depth, const size_t pv_index, Value alpha,
+                          const Value beta) {
     assert(searcher != nullptr);
-    assert(best_move_index != nullptr);
     assert(depth > 0);
+    assert(pv_index < searcher->root_move_count);
+    assert(alpha < beta);
 
-    atomic_fetch_add(&searcher->nodes_searched, 1);
+    if (!count_node(searcher))
+        return SIZE_MAX;
 
-    // In root search, alpha is equivalent to the best value.
-    Value alpha          = MIN_VALUE;
-    constexpr Value beta = MAX_VALUE;
+    size_t best_move_index = SIZE_MAX;
 
     struct PositionInfo info;
-    for (size_t i = 0; i < searcher->root_move_count; ++i) {
-        Move move = searcher->root_moves[i];
-        if (i >= searcher->sorted_until_index) {
-            move = pick_root_move(searcher->root_moves, searcher->root_move_values, searcher->root_move_count, i);
-            ++searcher->sorted_until_index;
-        }
+    for (size_t i = pv_index; i < searcher->root_move_count; ++i) {
+        struct RootMove* root_move = &searcher->root_moves[i];
 
-        do_move(&searcher->root_position, &info, move);
+        // A depth 1 search does not touch the principal variation of ply 1, so we reset it here.
+        searcher->principal_variation_length[1] = 0;
+
+        const uint64_t nodes_before = atomic_load(&searcher->nodes_searched);
+
+        do_move(&searcher->root_position, &info, root_move->move);
 
         const Value value = -alphabeta(searcher, &searcher->root_position, -beta, -alpha, depth - 1, 1);
 
-        undo_move(&searcher->root_position, move);
+        undo_move(&searcher->root_position, root_move->move);
+
+        SEARCH_TRACE_NODE(searcher, root_move->move, i, 1, depth - 1, -beta, -alpha, -value);
+
+        root_move->nodes += atomic_load(&searcher->nodes_searched) - nodes_before;
 
         // If the search has not been aborted at this point, it means that the current move has been searched
         // completely, meaning we can trust the result stored in value.
         if (value > alpha && !atomic_load(&searcher->thread_pool->search_aborted)) {
-            alpha            = value;
-            *best_move_index = i;
-
-            // Update the current principal variation. This is the new best move followed by the principal variation of
-            // that best move. Notice that principle_variation_table[1] was already computed in the alphabeta call
-            // above, so this works recursively and is well defined.
-            searcher->principal_variation_table[0][0] = move;
-            memcpy(&searcher->principal_variation_table[0][1], &searcher->principal_variation_table[1][0],
+            alpha           = value;
+            best_move_index = i;
+
+            // Update the principal variation of the root move. This is the root move followed by the principal
+            // variation of ply 1, which was computed in the alphabeta call above.
+            root_move->value = value;
+            root_move->depth = depth;
+            memcpy(&root_move->principal_variation[1], &searcher->principal_variation_table[1][0],
                    searcher->principal_variation_length[1] * sizeof(Move));
-            searcher->principal_variation_length[0] = searcher->principal_variation_length[1] + 1;
+            root_move->principal_variation_length = searcher->principal_variation_length[1] + 1;
+
+            if (value >= beta)
+                break;
         }
 
         if (atomic_load(&searcher->thread_pool->stop_search))
             break;
     }
 
-    return alpha;
+    return best_move_index;
 }
 
+// Searches the line at `pv_index` of `searcher` to `depth` and moves the best root move of that line to `pv_index`.
+// Returns whether the line has been searched completely.
+static bool search_line(struct Searcher* searcher, const size_t depth, const size_t pv_index) {
+    assert(searcher != nullptr);
+    assert(depth > 0);
+    assert(pv_index < searcher->root_move_count);
+
+    // The root moves of this line have all been searched in the previous lines as well, where they could not beat the
+    // best move of the previous line. So, at this depth, the value of the previous line is an upper bound for the
+    // value of this line, which allows us to search with a tighter window.
+    Value beta = MAX_VALUE;
+    if (pv_index > 0 && searcher->root_moves[pv_index - 1].value < MAX_VALUE)
+        beta = searcher->root_moves[pv_index - 1].value + 1;
+
+    size_t best_move_index = root_search(searcher, depth, pv_index, MIN_VALUE, beta);
+
+    // Search instability may cause the upper bound to be exceeded anyway, in which case we search again with a full
+    // window to obtain an exact value.
+    if (best_move_index != SIZE_MAX && searcher->root_moves[best_move_index].value >= beta
+        && !atomic_load(&searcher->thread_pool->stop_search))
+        best_move_index = root_search(searcher, depth, pv_index, MIN_VALUE, MAX_VALUE);
+
+    if (best_move_index == SIZE_MAX)
+        return false;
+
+    // Move the best root move to the front of the line, keeping the order of the other root moves intact such that
+    // they are searched in the same order in the next line.
+    const struct RootMove best_root_move = searcher->root_moves[best_move_index];
+    memmove(&searcher->root_moves[pv_index + 1], &searcher->root_moves[pv_index],
+            (best_move_index - pv_index) * sizeof(*searcher->root_moves));
+    searcher->root_moves[pv_index] = best_root_move;
+
+    return true;
+}
 
-// Collects info from `thread_pool` and prints this to UCI together with `depth`, `multipv` and `elapsed_time`.
-static void long_info(const struct ThreadPool* thread_pool, const size_t depth, const size_t multipv,
-                      const uint64_t elapsed_time) {
+
+#ifdef SEARCH_STATISTICS
+// Sums the search statistics of all searchers of `thread_pool` and prints them to UCI, together with the effective
+// branching factor of the last iteration of the main searcher.
+static void statistics_info(const struct ThreadPool* thread_pool) {
     assert(thread_pool != nullptr);
-    assert(depth > 0);
-    assert(multipv > 0);
-    assert(elapsed_time > 0);
 
-    size_t nodes_searched = 0;
-    for (size_t i = 0; i < thread_pool->thread_count; ++i)
-        nodes_searched += atomic_load(&thread_pool->threads[i].searcher.nodes_searched);
+    // The nodes are summed together with the counters, as the other searchers keep searching in the meantime.
+    uint64_t nodes_searched        = 0;
+    uint64_t quiescence_nodes      = 0;
+    uint64_t cutoffs               = 0;
+    uint64_t first_move_cutoffs    = 0;
+    uint64_t cutoff_index_sum      = 0;
+    uint64_t material_draw_cutoffs = 0;
+    for (size_t i = 0; i < thread_pool->thread_count; ++i) {
+        const struct Searcher* searcher           = &thread_pool->threads[i].searcher;
+        const struct SearchStatistics* statistics = &searcher->statistics;
+
+        nodes_searched += atomic_load(&searcher->nodes_searched);
+        quiescence_nodes += atomic_load_explicit(&statistics->quiescence_nodes, memory_order_relaxed);
+        cutoffs += atomic_load_explicit(&statistics->cutoffs, memory_order_relaxed);
+        first_move_cutoffs += atomic_load_explicit(&statistics->first_move_cutoffs, memory_order_relaxed);
+        cutoff_index_sum += atomic_load_explicit(&statistics->cutoff_index_sum, memory_order_relaxed);
+        material_draw_cutoffs += atomic_load_explicit(&statistics->material_draw_cutoffs, memory_order_relaxed);
+    }
+
+    // The effective branching factor is the ratio between the nodes of the last iteration and the iteration before.
+    const struct Searcher* main_searcher = &main_thread(thread_pool)->searcher;
+    const size_t depth                   = main_searcher->root_moves[0].depth;
+    const uint64_t* iteration_nodes      = main_searcher->statistics.iteration_nodes;
+    double branching_factor              = 0.0;
+    if (depth >= 2 && iteration_nodes[depth - 1] > iteration_nodes[depth - 2])
+        branching_factor = (double)(iteration_nodes[depth] - iteration_nodes[depth - 1])
+                         / (double)(iteration_nodes[depth - 1] - iteration_nodes[depth - 2]);
+
+    uci_search_statistics_info(nodes_searched, quiescence_nodes, cutoffs, first_move_cutoffs, cutoff_index_sum,
+                               material_draw_cutoffs, branching_factor);
+}
+#endif /* #ifdef SEARCH_STATISTICS */
+
+// Collects info from `thread_pool` and prints the first `multi_pv` lines of the best searcher to UCI together with
+// `elapsed_time`.
+static void long_info(const struct ThreadPool* thread_pool, const size_t multi_pv, const uint64_t elapsed_time) {
+    assert(thread_pool != nullptr);
+    assert(elapsed_time > 0);
 
     const struct Searcher* winner = best_searcher(thread_pool);
+    const size_t nodes_searched   = total_nodes_searched(thread_pool);
+    const uint64_t tablebase_hits = total_tablebase_hits(thread_pool);
 
-    uci_long_info(depth, multipv, winner->best_value, nodes_searched, elapsed_time,
-                  winner->principal_variation_table[0], winner->principal_variation_length[0]);
+    for (size_t i = 0; i < multi_pv; ++i) {
+        const struct RootMove* root_move = &winner->root_moves[i];
+
+        // Lines that have not been searched at all yet have no meaningful value.
+        if (root_move->depth == 0)
+            continue;
+
+        uci_long_info(root_move->depth, i + 1, root_move->value, nodes_searched, tablebase_hits, elapsed_time,
+                      root_move->principal_variation, root_move->principal_variation_length);
+    }
+
+#ifdef SEARCH_STATISTICS
+    if (thread_pool->options->debug_mode)
+        statistics_info(thread_pool);
+#endif /* #ifdef SEARCH_STATISTICS */
 }
 
 // Make `searcher` perform iterative deepening.
@@ -240,33 +411,61 @@ static void iterative_deepening(struct Searcher* searcher) {
     const uint64_t start_time = get_time_us();
     const size_t max_depth    = searcher->thread_pool->search_arguments->max_search_depth;
 
+    // Without root moves there is nothing to search, see perform_search().
+    if (searcher->root_move_count == 0)
+        return;
+
+    size_t multi_pv = searcher->thread_pool->options->multi_pv;
+    if (multi_pv > searcher->root_move_count)
+        multi_pv = searcher->root_move_count;
+
+    // Information about previous iterations used by the time manager.
+    Move previous_best_move    = NULL_MOVE;
+    Value previous_value       = MIN_VALUE;
+    size_t best_move_stability = 0;
+
     for (size_t depth = 1; depth <= max_depth; ++depth) {
-        size_t best_move_index = SIZE_MAX;
-        const Value best_value = root_search(searcher, depth, &best_move_index);
-
-        // If we have completely searched at least one root move, we update the best value. Else, the search result
-        // can not be trusted.
-        if (best_move_index != SIZE_MAX) {
-            atomic_store(&searcher->best_value, best_value);
-
-            // Make sure the new best move is checked first in the next iteration.
-            searcher->root_moves[best_move_index] = searcher->root_moves[0];
-            searcher->root_moves[0]               = searcher->principal_variation_table[0][0];
-        } else {
-            // if best_move_index == SIZE_MAX, the search was aborted for sure and not a single move has been searched
-            // completely, this means that, essantially, we still have not searched the current depth, and thus we
-            // decrease it for the long_info() call later on.
-            --depth;
+        // The lines are searched from best to worst, so if the first line has been searched completely, the best move
+        // has been updated.
+        for (size_t pv_index = 0; pv_index < multi_pv; ++pv_index) {
+            if (!search_line(searcher, depth, pv_index))
+                break;
+
+            if (pv_index == 0)
+                atomic_store(&searcher->best_value, searcher->root_moves[0].value);
+
+            if (atomic_load(&searcher->thread_pool->stop_search))
+                break;
         }
 
         if (is_main_thread(searcher)) {
+#ifdef SEARCH_STATISTICS
+            searcher->statistics.iteration_nodes[depth] = total_nodes_searched(searcher->thread_pool);
+#endif /* #ifdef SEARCH_STATISTICS */
+
             const uint64_t elapsed_time = get_time_us() - start_time;
-            long_info(searcher->thread_pool, depth, 1, elapsed_time);
+            long_info(searcher->thread_pool, multi_pv, elapsed_time);
+
+            // We stop if we have found mate.
+            if (is_mate_value(best_searcher(searcher->thread_pool)->best_value))
+                atomic_store(&searcher->thread_pool->stop_search, true);
+
+            const struct RootMove* best_root_move = &searcher->root_moves[0];
+            best_move_stability = (best_root_move->move == previous_best_move) ? best_move_stability + 1 : 0;
 
-            // We stop if we have searched too many nodes or we have found mate.
-            if (searcher->nodes_searched > searcher->thread_pool->search_arguments->max_search_nodes
-                || is_mate_value(best_searcher(searcher->thread_pool)->best_value))
+            const uint64_t nodes_searched = atomic_load(&searcher->nodes_searched);
+            const uint64_t node_share     = (nodes_searched == 0) ? 0 : 1000 * best_root_move->nodes / nodes_searched;
+            const Value value_drop        = (previous_value == MIN_VALUE) ? 0 : previous_value - best_root_move->value;
+
+            // The optimum time is only valid when not pondering, and an infinite search has none.
+            if (!searcher->thread_pool->search_arguments->infinite_search
+                && !atomic_load(&searcher->thread_pool->pondering)
+                && optimum_time_exceeded(searcher->thread_pool->time_manager, best_move_stability, node_share,
+                                         value_drop))
                 atomic_store(&searcher->thread_pool->stop_search, true);
+
+            previous_best_move = best_root_move->move;
+            previous_value     = best_root_move->value;
         }
 
         if (atomic_load(&searcher->thread_pool->stop_search))
@@ -275,24 +474,230 @@ static void iterative_deepening(struct Searcher* searcher) {
 }
 
 
+// Locks the result of the root move at `index` in `root_move_queue`.
+static INLINE void lock_root_move(struct RootMoveQueue* root_move_queue, const size_t index) {
+    assert(root_move_queue != nullptr);
+    assert(index < root_move_queue->root_move_count);
+
+    while (atomic_flag_test_and_set_explicit(&root_move_queue->root_move_locks[index], memory_order_acquire)) {}
+}
+
+// Unlocks the result of the root move at `index` in `root_move_queue`.
+static INLINE void unlock_root_move(struct RootMoveQueue* root_move_queue, const size_t index) {
+    assert(root_move_queue != nullptr);
+    assert(index < root_move_queue->root_move_count);
+
+    atomic_flag_clear_explicit(&root_move_queue->root_move_locks[index], memory_order_release);
+}
+
+// Compares two root moves such that qsort() orders them from highest to lowest value.
+static int compare_root_moves(const void* root_move1, const void* root_move2) {
+    const Value value1 = ((const struct RootMove*)root_move1)->value;
+    const Value value2 = ((const struct RootMove*)root_move2)->value;
+
+    return (value1 < value2) - (value1 > value2);
+}
+
+// Prints the results of all root moves in the root move queue of `thread_pool` to UCI, ordered from best to worst, if
+// all root moves have been searched to a depth that has not been reported yet. Should only be called by the main thread.
+static void split_info(struct ThreadPool* thread_pool, const uint64_t elapsed_time) {
+    assert(thread_pool != nullptr);
+
+    struct RootMoveQueue* root_move_queue = &thread_pool->root_move_queue;
+    const size_t root_move_count          = root_move_queue->root_move_count;
+
+    size_t completed_depth = MAX_SEARCH_DEPTH;
+    for (size_t i = 0; i < root_move_count; ++i) {
+        lock_root_move(root_move_queue, i);
+        if (root_move_queue->root_moves[i].depth < completed_depth)
+            completed_depth = root_move_queue->root_moves[i].depth;
+        unlock_root_move(root_move_queue, i);
+    }
+
+    if (completed_depth <= root_move_queue->reported_depth)
+        return;
+
+    root_move_queue->reported_depth = completed_depth;
+
+    // Take a snapshot of the results, such that they do not change while we are sorting and reporting them.
+    struct RootMove root_moves[MAX_MOVES];
+    for (size_t i = 0; i < root_move_count; ++i) {
+        lock_root_move(root_move_queue, i);
+        memcpy(&root_moves[i], &root_move_queue->root_moves[i], sizeof(*root_moves));
+        unlock_root_move(root_move_queue, i);
+    }
+
+    qsort(root_moves, root_move_count, sizeof(*root_moves), compare_root_moves);
+
+    const size_t nodes_searched   = total_nodes_searched(thread_pool);
+    const uint64_t tablebase_hits = total_tablebase_hits(thread_pool);
+    for (size_t i = 0; i < root_move_count; ++i)
+        uci_long_info(root_moves[i].depth, i + 1, root_moves[i].value, nodes_searched, tablebase_hits, elapsed_time,
+                      root_moves[i].principal_variation, root_moves[i].principal_variation_length);
+}
+
+// Returns the best root move in the root move queue of `thread_pool`. Root moves that have not been searched completely
+// at least once are never preferred over root moves that have.
+static struct RootMove split_best_root_move(struct ThreadPool* thread_pool) {
+    assert(thread_pool != nullptr);
+    assert(thread_pool->root_move_queue.root_move_count > 0);
+
+    struct RootMoveQueue* root_move_queue = &thread_pool->root_move_queue;
+
+    // Just like in start_searching(), the first move is the fallback for very short searches.
+    struct RootMove best_root_move = root_move_queue->root_moves[0];
+    Value best_value               = MIN_VALUE;
+    for (size_t i = 0; i < root_move_queue->root_move_count; ++i) {
+        lock_root_move(root_move_queue, i);
+        const struct RootMove* root_move = &root_move_queue->root_moves[i];
+        if (root_move->depth > 0 && root_move->value > best_value) {
+            best_root_move = *root_move;
+            best_value     = root_move->value;
+        }
+        unlock_root_move(root_move_queue, i);
+    }
+
+    return best_root_move;
+}
+
+// Make `searcher` take work items from the root move queue until the queue is exhausted or the search is stopped. Every
+// root move is searched with a full window, such that its value is exact and can be compared to other root moves.
+static void split_root_search(struct Searcher* searcher) {
+    assert(searcher != nullptr);
+
+    struct ThreadPool* thread_pool        = searcher->thread_pool;
+    struct RootMoveQueue* root_move_queue = &thread_pool->root_move_queue;
+    const size_t root_move_count          = root_move_queue->root_move_count;
+    const size_t max_depth                = thread_pool->search_arguments->max_search_depth;
+    const uint64_t start_time             = get_time_us();
+
+    // Without root moves there are no work items, see perform_search().
+    if (root_move_count == 0)
+        return;
+
+    struct PositionInfo info;
+    while (!atomic_load(&thread_pool->stop_search)) {
+        const size_t item  = atomic_fetch_add(&root_move_queue->next_item, 1);
+        const size_t depth = item / root_move_count + 1;
+        const size_t index = item % root_move_count;
+
+        if (depth > max_depth)
+            break;
+
+        if (!count_node(searcher))
+            break;
+
+        // The root moves of the queue never change during the search, so we do not need to lock here.
+        const Move move = root_move_queue->root_moves[index].move;
+
+        // A depth 1 search does not touch the principal variation of ply 1, so we reset it here.
+        searcher->principal_variation_length[1] = 0;
+
+        do_move(&searcher->root_position, &info, move);
+        const Value value = -alphabeta(searcher, &searcher->root_position, MIN_VALUE, MAX_VALUE, depth - 1, 1);
+        undo_move(&searcher->root_position, move);
+        SEARCH_TRACE_NODE(searcher, move, index, 1, depth - 1, MIN_VALUE, MAX_VALUE, -value);
+
+        // A search that was interrupted can not be trusted.
+        if (atomic_load(&thread_pool->stop_search))
+            break;
+
+        lock_root_move(root_move_queue, index);
+        struct RootMove* root_move = &root_move_queue->root_moves[index];
+
+        // Another thread might have finished this root move at a higher depth in the meantime.
+        if (depth > root_move->depth) {
+            root_move->value = value;
+            root_move->depth = depth;
+
+            memcpy(&root_move->principal_variation[1], &searcher->principal_variation_table[1][0],
+                   searcher->principal_variation_length[1] * sizeof(Move));
+            root_move->principal_variation_length = searcher->principal_variation_length[1] + 1;
+        }
+        unlock_root_move(root_move_queue, index);
+
+        if (is_main_thread(searcher))
+            split_info(thread_pool, get_time_us() - start_time);
+    }
+
+    atomic_fetch_add(&root_move_queue->finished_searchers, 1);
+
+    if (!is_main_thread(searcher))
+        return;
+
+    // The other threads may still be working on their last work items. As the main thread is the only thread that
+    // checks the search time, it keeps doing so until all other threads are done.
+    while (atomic_load(&root_move_queue->finished_searchers) < thread_pool->thread_count
+           && !atomic_load(&thread_pool->stop_search)) {
+        if (!thread_pool->search_arguments->infinite_search)
+            stop_if_time_exceeded(searcher);
+
+        thrd_sleep(&(struct timespec){.tv_nsec = 1000000}, nullptr);  // 1 ms.
+    }
+
+    split_info(thread_pool, get_time_us() - start_time);
+}
+
+
 void perform_search(struct Searcher* searcher) {
     assert(searcher != nullptr);
 
-    iterative_deepening(searcher);
+    // A mate search takes precedence over splitting root moves.
+    const bool find_mate        = searcher->thread_pool->search_arguments->mate_in_x != 0;
+    const bool split_root_moves = !find_mate && searcher->thread_pool->options->split_root_moves;
+
+    // The mate search is performed by the main thread only, the other threads are done immediately.
+    if (find_mate) {
+        if (is_main_thread(searcher))
+            mate_search(searcher);
+    } else if (split_root_moves) {
+        split_root_search(searcher);
+    } else {
+        iterative_deepening(searcher);
+    }
 
     if (!is_main_thread(searcher))
         return;
 
-    // If we are searching in ponder mode or with infinite depth, we must not output a best move before the stop command
-    // as stated by the UCI protocol.
-    const bool stop_required = searcher->thread_pool->search_arguments->ponder
-                            || searcher->thread_pool->search_arguments->infinite_search;
-    while (!atomic_load(&searcher->thread_pool->stop_search) && stop_required) {}
+    // If we are searching in ponder mode or with infinite depth, we must not output a best move before the stop or
+    // ponderhit command as stated by the UCI protocol. The search may also have stopped itself, e.g. after finding a
+    // mate or reaching the node limit, which does not end pondering.
+    const bool infinite_search = searcher->thread_pool->search_arguments->infinite_search;
+    while (!atomic_load(&searcher->thread_pool->stop_received)
+           && (infinite_search || atomic_load(&searcher->thread_pool->pondering)))
+        thrd_sleep(&(struct timespec){.tv_nsec = 1000000}, nullptr);  // 1 ms.
 
     // Other threads might still be stopping their search which can cause incorrect results in uci_best_move().
     // Therefore, we wait until all threads except for the main thread (as the main thread is right here) finished
     // searching.
     wait_until_finished_searching(searcher->thread_pool, /* Do not wait for main thread */ false);
 
-    uci_best_move(best_move(best_searcher(searcher->thread_pool)));
+    // Without legal moves there is no best move, whether the root moves were split or not.
+    if (searcher->root_move_count == 0) {
+        uci_best_move(NULL_MOVE, NULL_MOVE);
+        atomic_store(&searcher->thread_pool->stop_search, true);
+        return;
+    }
+
+    const struct RootMove best_root_move = split_root_moves ? split_best_root_move(searcher->thread_pool)
+                                                            : best_searcher(searcher->thread_pool)->root_moves[0];
+
+    // The move we expect the opponent to play is the second move of the principal variation.
+    const Move ponder_move = (best_root_move.principal_variation_length > 1) ? best_root_move.principal_variation[1]
+                                                                              : NULL_MOVE;
+
+    uint64_t eval_cache_probes = 0;
+    uint64_t eval_cache_hits   = 0;
+    for (size_t i = 0; i < searcher->thread_pool->thread_count; ++i) {
+        eval_cache_probes += searcher->thread_pool->threads[i].searcher.eval_cache.probes;
+        eval_cache_hits += searcher->thread_pool->threads[i].searcher.eval_cache.hits;
+    }
+
+    if (searcher->thread_pool->options->debug_mode && eval_cache_probes > 0)
+        uci_eval_cache_info(eval_cache_probes, eval_cache_hits);
+
+    uci_best_move(best_root_move.move, ponder_move);
+
+    // The search is over, which allows the thread pool to be resized.
+    atomic_store(&searcher->thread_pool->stop_search, true);
 }
@@ -7,22 +7,95 @@
 #include <stdint.h>
 
 #include "constants.h"
+#include "eval_cache.h"
+#include "material.h"
 #include "move.h"
+#include "nnue.h"
+#include "pawns.h"
 #include "position.h"
 #include "score.h"
 #include "threads.h"
+#include "trace.h"
 #include "util.h"
 
 
 
+// This struct contains the search result of a single root move: the depth to which it has been searched, the value it
+// obtained at that depth, the effort spent on it and the principal variation starting with the root move itself.
+struct RootMove {
+    Move move;
+    Value value;
+    size_t depth;
+
+    // The number of nodes searched in the subtree of this root move over all iterations.
+    uint64_t nodes;
+
+    Move principal_variation[MAX_SEARCH_DEPTH];
+    size_t principal_variation_length;
+};
+
+#ifdef SEARCH_STATISTICS
+// This struct contains counters that describe the quality of the search of a single searcher. They only exist in builds
+// with SEARCH_STATISTICS defined, such that regular builds do not pay for them. Every counter is only written by its
+// own searcher, but the main thread reads them while searching, hence they are atomic.
+struct SearchStatistics {
+    _Atomic(uint64_t) quiescence_nodes;
+
+    // The number of beta cutoffs in alphabeta(), the number of those caused by the first move searched and the sum of
+    // the indices of the moves that caused them.
+    _Atomic(uint64_t) cutoffs;
+    _Atomic(uint64_t) first_move_cutoffs;
+    _Atomic(uint64_t) cutoff_index_sum;
+
+    // The number of nodes that are not searched because neither side has enough material to mate.
+    _Atomic(uint64_t) material_draw_cutoffs;
+
+    // The total number of nodes of all searchers at the end of each iteration. Only kept by the main searcher.
+    uint64_t iteration_nodes[MAX_SEARCH_DEPTH + 1];
+};
+
+// Adds `amount` to `counter`. As the counter has a single writer, an atomic read-modify-write is not necessary.
+static INLINE void add_search_statistic(_Atomic(uint64_t)* counter, const uint64_t amount) {
+    assert(counter != nullptr);
+
+    atomic_store_explicit(counter, atomic_load_explicit(counter, memory_order_relaxed) + amount, memory_order_relaxed);
+}
+
+#    define SEARCH_STATISTIC_ADD(searcher, counter, amount) \
+        add_search_statistic(&(searcher)->statistics.counter, (amount))
+#else
+#    define SEARCH_STATISTIC_ADD(searcher, counter, amount) ((void)0)
+#endif /* #ifdef SEARCH_STATISTICS */
+
+// Search tracing records every searched node, see trace.h. Like the statistics, it only exists in builds with
+// SEARCH_TRACE defined.
+#ifdef SEARCH_TRACE
+#    define SEARCH_TRACE_ENTER(searcher, ply)         enter_trace_node(&(searcher)->trace, (ply))
+#    define SEARCH_TRACE_CUTOFF(searcher, ply, index) trace_cutoff(&(searcher)->trace, (ply), (index))
+#    define SEARCH_TRACE_NODE(searcher, move, move_index, ply, depth, alpha, beta, value) \
+        trace_node(&(searcher)->trace, (move), (move_index), (ply), (depth), (alpha), (beta), (value))
+#else
+#    define SEARCH_TRACE_ENTER(searcher, ply)                                             ((void)0)
+#    define SEARCH_TRACE_CUTOFF(searcher, ply, index)                                     ((void)0)
+#    define SEARCH_TRACE_NODE(searcher, move, move_index, ply, depth, alpha, beta, value) ((void)0)
+#endif /* #ifdef SEARCH_TRACE */
+
 // This struct contains thread local search information.
 struct Searcher {
+    // The searcher has its own copy of the root position info, as the accumulators of the root are computed by every
+    // searcher.
     struct Position root_position;
-    Move root_moves[MAX_MOVES];
-    size_t root_move_count;
+    struct PositionInfo root_info;
 
-    int8_t root_move_values[MAX_MOVES];
-    size_t sorted_until_index;
+    struct Evaluator evaluator;
+    struct PawnTable pawn_table;
+    struct MaterialTable material_table;
+    struct EvalCache eval_cache;
+
+    // The root moves are ordered from best to worst line. When searching multiple principal variations, the first
+    // `multi_pv` root moves are the best lines found so far.
+    struct RootMove root_moves[MAX_MOVES];
+    size_t root_move_count;
 
     // principal_variation_table[i][j] is the jth move of the principle variation at depth i. We have 0 <= j <=
     // principle_variation_length[i].
@@ -31,6 +104,18 @@ struct Searcher {
 
     _Atomic(Value) best_value;
     _Atomic(uint64_t) nodes_searched;
+    _Atomic(uint64_t) tablebase_hits;
+
+    // The number of nodes this searcher may still search before it needs to claim more nodes from the thread pool.
+    uint64_t node_budget;
+
+#ifdef SEARCH_STATISTICS
+    struct SearchStatistics statistics;
+#endif /* #ifdef SEARCH_STATISTICS */
+
+#ifdef SEARCH_TRACE
+    struct SearchTrace trace;
+#endif /* #ifdef SEARCH_TRACE */
 
     struct ThreadPool* thread_pool;
     size_t thread_index;
@@ -48,7 +133,7 @@ static INLINE Move best_move(const struct Searcher* searcher) {
     assert(searcher != nullptr);
 
     // This move is guaranteed to exist by definition of start_searching().
-    return searcher->principal_variation_table[0][0];
+    return searcher->root_moves[0].move;
 }
 
 
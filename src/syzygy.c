@@ -0,0 +1,1346 @@
+#include "syzygy.h"
+
+#include <assert.h>
+#include <dirent.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <stdatomic.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <threads.h>
+#include <unistd.h>
+
+#include "bitboard.h"
+#include "board.h"
+#include "constants.h"
+#include "move.h"
+#include "move_generation.h"
+#include "piece.h"
+#include "position.h"
+#include "util.h"
+#include "zobrist.h"
+
+
+
+// The probing code follows the Syzygy format by Ronald de Man. A table stores the outcome of every position of a
+// material configuration, compressed with recursive pairing and canonical Huffman codes. Positions are mapped to an
+// index by exploiting the symmetries of the board, which differ between tables with and without pawns.
+
+// The number of entries of the index from material keys to tables, which must be a power of two. Both material keys of
+// all tables up to 7 pieces fit comfortably.
+static constexpr size_t TABLEBASE_INDEX_SIZE = 1 << 13;
+static_assert((TABLEBASE_INDEX_SIZE & (TABLEBASE_INDEX_SIZE - 1)) == 0);
+
+static constexpr size_t TABLEBASE_NAME_MAX_LENGTH = 16;
+static constexpr size_t TABLEBASE_PATH_MAX_LENGTH = 4096;
+
+// Every file starts with a magic number, after which the data is aligned to 64 bytes except for a trailing 16 bytes.
+static constexpr uint8_t WDL_MAGIC[4] = {0x71, 0xE8, 0x23, 0x5D};
+static constexpr uint8_t DTZ_MAGIC[4] = {0xD7, 0x66, 0x0C, 0xA5};
+
+// The bound on the rank of a root move that is won or lost regardless of the 50 move rule.
+static constexpr int MAX_DTZ = 1 << 18;
+
+// The flags of a compressed table.
+enum PairsFlag : uint8_t {
+    PAIRS_FLAG_SIDE_TO_MOVE = 1,
+    PAIRS_FLAG_MAPPED       = 2,
+    PAIRS_FLAG_WIN_PLIES    = 4,
+    PAIRS_FLAG_LOSS_PLIES   = 8,
+    PAIRS_FLAG_WIDE         = 16,
+    PAIRS_FLAG_SINGLE_VALUE = 128
+};
+
+// The state of a probe. When a DTZ table only stores the other side to move, the position has to be resolved by a 1 ply
+// search. When the best move is a capture or pawn move, the DTZ tables contain no useful value for the position.
+enum ProbeState {
+    PROBE_FAILED,
+    PROBE_OK,
+    PROBE_CHANGE_SIDE_TO_MOVE,
+    PROBE_ZEROING_BEST_MOVE
+};
+
+// A compressed table of one side to move and, for tables with pawns, one file of the leading pawn. All pointers point
+// into the mapped file, except for `base` and `symbol_lengths`, which are computed when the file is mapped.
+struct PairsData {
+    uint8_t flags;
+    uint8_t min_symbol_length;  // The stored value of single value tables.
+
+    size_t block_size;
+    size_t span;
+    size_t block_count;
+    size_t block_length_count;
+    size_t sparse_index_count;
+
+    const uint8_t* lowest_symbols;  // Little endian 16 bit values.
+    const uint8_t* tree;            // Two 12 bit symbols per symbol.
+    const uint8_t* sparse_index;    // A 32 bit block and a 16 bit offset per entry, little endian.
+    const uint8_t* block_lengths;   // Little endian 16 bit values.
+    const uint8_t* data;
+
+    uint64_t* base;
+    uint8_t* symbol_lengths;
+
+    // The pieces in the order of the encoding, as stored in the file: the piece type plus 1 and 8 for black pieces.
+    uint8_t pieces[TABLEBASE_MAX_PIECES];
+    uint64_t group_index[TABLEBASE_MAX_PIECES + 1];
+    uint8_t group_length[TABLEBASE_MAX_PIECES + 1];
+
+    // DTZ tables map the stored values per outcome.
+    uint16_t map_index[4];
+};
+
+// A WDL or DTZ file of a table. It is mapped when it is probed for the first time.
+struct TablebaseFile {
+    _Atomic(bool) ready;
+    void* mapping;
+    size_t mapping_size;
+
+    // WDL files store both sides to move unless the table is symmetric, DTZ files store only one side to move.
+    size_t side_count;
+    struct PairsData pairs[COLOR_COUNT][FILE_D + 1];
+
+    const uint8_t* dtz_map;
+};
+
+// A table of a material configuration. The file name gives the stronger side first, which is white in the encoding.
+// `keys[COLOR_WHITE]` is the material key with the stronger side as white and `keys[COLOR_BLACK]` with the stronger
+// side as black.
+struct Tablebase {
+    char name[TABLEBASE_NAME_MAX_LENGTH];
+    ZobristKey keys[COLOR_COUNT];
+
+    size_t piece_count;
+    bool has_pawns;
+    bool has_unique_pieces;
+
+    // The pawns of the leading color, which is the color with fewer pawns but at least one, and of the other color.
+    size_t pawn_counts[COLOR_COUNT];
+
+    struct TablebaseFile wdl;
+    struct TablebaseFile dtz;
+};
+
+struct TablebaseIndexEntry {
+    ZobristKey key;
+    size_t table;  // The index of the table plus 1, or 0 for an empty entry.
+};
+
+
+static struct Tablebase* tablebases;
+static size_t tablebase_count;
+static size_t max_tablebase_piece_count;
+static struct TablebaseIndexEntry tablebase_index[TABLEBASE_INDEX_SIZE];
+static char tablebase_paths[TABLEBASE_PATH_MAX_LENGTH];
+
+// Files are mapped lazily by whichever thread probes them first.
+static mtx_t mapping_mutex;
+static once_flag tablebase_once = ONCE_FLAG_INIT;
+
+// The encoding tables, see initialize_encoding().
+static uint64_t binomial[TABLEBASE_MAX_PIECES - 1][SQUARE_COUNT];
+static int map_pawns[SQUARE_COUNT];
+static uint64_t lead_pawn_index[TABLEBASE_MAX_PIECES - 1][SQUARE_COUNT];
+static uint64_t lead_pawns_size[TABLEBASE_MAX_PIECES - 1][FILE_D + 1];
+static int map_b1h1h7[SQUARE_COUNT];
+static int map_a1d1d4[SQUARE_COUNT];
+static int map_kk[10][SQUARE_COUNT];
+
+
+static INLINE uint16_t read_le16(const uint8_t* data) {
+    return (uint16_t)(data[0] | data[1] << 8);
+}
+
+static INLINE uint32_t read_le32(const uint8_t* data) {
+    return (uint32_t)data[0] | (uint32_t)data[1] << 8 | (uint32_t)data[2] << 16 | (uint32_t)data[3] << 24;
+}
+
+static INLINE uint32_t read_be32(const uint8_t* data) {
+    return (uint32_t)data[0] << 24 | (uint32_t)data[1] << 16 | (uint32_t)data[2] << 8 | (uint32_t)data[3];
+}
+
+static INLINE uint64_t read_be64(const uint8_t* data) {
+    return (uint64_t)read_be32(data) << 32 | read_be32(data + 4);
+}
+
+// Returns the left child of `symbol` in the pairing tree of `pairs`. For a leaf, this is the stored value.
+static INLINE uint16_t left_symbol(const struct PairsData* pairs, const size_t symbol) {
+    const uint8_t* node = pairs->tree + 3 * symbol;
+    return (uint16_t)((node[1] & 0xF) << 8 | node[0]);
+}
+
+// Returns the right child of `symbol` in the pairing tree of `pairs`, which is 0xFFF for a leaf.
+static INLINE uint16_t right_symbol(const struct PairsData* pairs, const size_t symbol) {
+    const uint8_t* node = pairs->tree + 3 * symbol;
+    return (uint16_t)(node[2] << 4 | node[1] >> 4);
+}
+
+// Returns the signed distance of `square` to the a1-h8 diagonal, which is negative below the diagonal.
+static INLINE int off_diagonal(const int square) {
+    return (square >> 3) - (square & 7);
+}
+
+// Returns the encoding of `piece` in the table files.
+static INLINE uint8_t tablebase_piece(const enum Piece piece) {
+    return (uint8_t)((type_of_piece(piece) + 1) | color_of_piece(piece) << 3);
+}
+
+
+// Initializes the tables that map squares and groups of pieces to indices.
+static void initialize_encoding() {
+    // Squares below the a1-h8 diagonal.
+    int code = 0;
+    for (int square = SQUARE_A1; square <= SQUARE_H8; ++square) {
+        if (off_diagonal(square) < 0)
+            map_b1h1h7[square] = code++;
+    }
+
+    // Squares of the a1-d1-d4 triangle, with the squares on the diagonal last.
+    int diagonal[4];
+    size_t diagonal_count = 0;
+    code                  = 0;
+    for (int square = SQUARE_A1; square <= SQUARE_D4; ++square) {
+        if (off_diagonal(square) < 0 && (square & 7) <= FILE_D)
+            map_a1d1d4[square] = code++;
+        else if (off_diagonal(square) == 0 && (square & 7) <= FILE_D)
+            diagonal[diagonal_count++] = square;
+    }
+    for (size_t i = 0; i < diagonal_count; ++i)
+        map_a1d1d4[diagonal[i]] = code++;
+
+    // The 462 legal placements of two kings with the first one in the a1-d1-d4 triangle. If the first king is on the
+    // diagonal, the second one may not be above it. Placements with both kings on the diagonal come last.
+    int both_on_diagonal[64][2];
+    size_t both_on_diagonal_count = 0;
+    code                          = 0;
+    for (int index = 0; index < 10; ++index) {
+        for (int square1 = SQUARE_A1; square1 <= SQUARE_D4; ++square1) {
+            if (map_a1d1d4[square1] != index || (index == 0 && square1 != SQUARE_B1))
+                continue;
+
+            const Bitboard excluded = piece_base_attacks(PIECE_TYPE_KING, (enum Square)square1)
+                                    | square_bitboard((enum Square)square1);
+            for (int square2 = SQUARE_A1; square2 <= SQUARE_H8; ++square2) {
+                if ((excluded & square_bitboard((enum Square)square2)) != EMPTY_BITBOARD)
+                    continue;
+
+                if (off_diagonal(square1) == 0 && off_diagonal(square2) > 0)
+                    continue;
+
+                if (off_diagonal(square1) == 0 && off_diagonal(square2) == 0) {
+                    both_on_diagonal[both_on_diagonal_count][0]   = index;
+                    both_on_diagonal[both_on_diagonal_count++][1] = square2;
+                } else {
+                    map_kk[index][square2] = code++;
+                }
+            }
+        }
+    }
+    for (size_t i = 0; i < both_on_diagonal_count; ++i)
+        map_kk[both_on_diagonal[i][0]][both_on_diagonal[i][1]] = code++;
+
+    // binomial[k][n] is the number of ways to choose k of n squares.
+    binomial[0][0] = 1;
+    for (size_t n = 1; n < SQUARE_COUNT; ++n) {
+        for (size_t k = 0; k < TABLEBASE_MAX_PIECES - 1 && k <= n; ++k)
+            binomial[k][n] = ((k > 0) ? binomial[k - 1][n - 1] : 0) + ((k < n) ? binomial[k][n - 1] : 0);
+    }
+
+    // map_pawns maps the squares a2-h7 to the number of squares available to the other leading pawns, when the pawn on
+    // that square is the leading one. The leading pawn is the one closest to the edge and, within a file, the one with
+    // the lowest rank, which is the pawn with the highest value. The leading pawns are indexed per file of the leading
+    // pawn, as the tables are split by that file.
+    int available_squares = 47;
+    for (size_t lead_pawn_count = 1; lead_pawn_count < TABLEBASE_MAX_PIECES - 1; ++lead_pawn_count) {
+        for (int file = FILE_A; file <= FILE_D; ++file) {
+            uint64_t index = 0;
+            for (int rank = RANK_2; rank <= RANK_7; ++rank) {
+                const int square = 8 * rank + file;
+                if (lead_pawn_count == 1) {
+                    map_pawns[square]     = available_squares--;
+                    map_pawns[square ^ 7] = available_squares--;
+                }
+
+                lead_pawn_index[lead_pawn_count][square] = index;
+                index += binomial[lead_pawn_count - 1][map_pawns[square]];
+            }
+
+            lead_pawns_size[lead_pawn_count][file] = index;
+        }
+    }
+}
+
+static void initialize_tablebase_once() {
+    mtx_init(&mapping_mutex, mtx_plain);
+    initialize_encoding();
+}
+
+
+// Returns the table with material key `key`, or nullptr if there is none.
+static struct Tablebase* find_tablebase(const ZobristKey key) {
+    for (size_t i = key & (TABLEBASE_INDEX_SIZE - 1);; i = (i + 1) & (TABLEBASE_INDEX_SIZE - 1)) {
+        if (tablebase_index[i].table == 0)
+            return nullptr;
+
+        if (tablebase_index[i].key == key)
+            return &tablebases[tablebase_index[i].table - 1];
+    }
+}
+
+// Adds `key` of the table with index `table` to the index. The index is never filled completely, so a lookup always
+// finds an empty entry.
+static bool add_to_tablebase_index(const ZobristKey key, const size_t table) {
+    size_t used = 0;
+    size_t i    = key & (TABLEBASE_INDEX_SIZE - 1);
+    while (tablebase_index[i].table != 0) {
+        if (tablebase_index[i].key == key)
+            return true;  // Symmetric tables have the same key twice.
+
+        if (++used == TABLEBASE_INDEX_SIZE / 2)
+            return false;
+
+        i = (i + 1) & (TABLEBASE_INDEX_SIZE - 1);
+    }
+
+    tablebase_index[i].key   = key;
+    tablebase_index[i].table = table + 1;
+    return true;
+}
+
+// Parses the table name `name`, like KRPvKR, into the number of pieces per color and piece type, where the pieces
+// before the 'v' are white. Returns whether `name` is a valid table name.
+static bool parse_tablebase_name(const char* name, size_t counts[COLOR_COUNT][PIECE_TYPE_KING + 1]) {
+    assert(name != nullptr);
+
+    static constexpr char PIECE_TYPE_CHARACTERS[] = "PNBRQK";
+
+    memset(counts, 0, COLOR_COUNT * sizeof(*counts));
+
+    enum Color color   = COLOR_WHITE;
+    size_t piece_count = 0;
+    for (const char* c = name; *c != '\0'; ++c) {
+        if (*c == 'v') {
+            if (color == COLOR_BLACK)
+                return false;
+
+            color = COLOR_BLACK;
+            continue;
+        }
+
+        const char* piece_type = strchr(PIECE_TYPE_CHARACTERS, *c);
+        if (piece_type == nullptr)
+            return false;
+
+        ++counts[color][piece_type - PIECE_TYPE_CHARACTERS];
+        ++piece_count;
+    }
+
+    return color == COLOR_BLACK && counts[COLOR_WHITE][PIECE_TYPE_KING] == 1
+        && counts[COLOR_BLACK][PIECE_TYPE_KING] == 1 && piece_count <= TABLEBASE_MAX_PIECES;
+}
+
+// Returns the material key of a position with `counts` pieces per color and piece type, with the colors swapped if
+// `swap_colors` is set.
+static ZobristKey material_key_of_counts(const size_t counts[COLOR_COUNT][PIECE_TYPE_KING + 1],
+                                         const bool swap_colors) {
+    ZobristKey key = 0;
+    for (enum Color color = COLOR_WHITE; color < COLOR_COUNT; ++color) {
+        for (enum PieceType piece_type = PIECE_TYPE_PAWN; piece_type <= PIECE_TYPE_KING; ++piece_type) {
+            const enum Piece piece = create_piece(swap_colors ? opposite_color(color) : color, piece_type);
+            for (size_t n = 0; n < counts[color][piece_type]; ++n)
+                key ^= piece_zobrist_keys[piece][n];
+        }
+    }
+
+    return key;
+}
+
+// Adds the table `name`, whose WDL file has been found, unless a table with the same material was already added.
+static void add_tablebase(const char* name) {
+    assert(name != nullptr);
+
+    size_t counts[COLOR_COUNT][PIECE_TYPE_KING + 1];
+    if (!parse_tablebase_name(name, counts))
+        return;
+
+    struct Tablebase table = {0};
+    strcpy(table.name, name);
+    table.keys[COLOR_WHITE] = material_key_of_counts(counts, false);
+    table.keys[COLOR_BLACK] = material_key_of_counts(counts, true);
+
+    if (find_tablebase(table.keys[COLOR_WHITE]) != nullptr)
+        return;
+
+    for (enum Color color = COLOR_WHITE; color < COLOR_COUNT; ++color) {
+        for (enum PieceType piece_type = PIECE_TYPE_PAWN; piece_type <= PIECE_TYPE_KING; ++piece_type) {
+            table.piece_count += counts[color][piece_type];
+            if (piece_type != PIECE_TYPE_KING && counts[color][piece_type] == 1)
+                table.has_unique_pieces = true;
+        }
+    }
+
+    // The leading color is the color with fewer pawns, as that compresses better, but it must have a pawn.
+    const size_t white_pawns = counts[COLOR_WHITE][PIECE_TYPE_PAWN];
+    const size_t black_pawns = counts[COLOR_BLACK][PIECE_TYPE_PAWN];
+    const bool white_leads   = black_pawns == 0 || (white_pawns > 0 && black_pawns >= white_pawns);
+    table.has_pawns          = white_pawns + black_pawns > 0;
+    table.pawn_counts[0]     = white_leads ? white_pawns : black_pawns;
+    table.pawn_counts[1]     = white_leads ? black_pawns : white_pawns;
+
+    struct Tablebase* grown = realloc(tablebases, (tablebase_count + 1) * sizeof(*tablebases));
+    if (grown == nullptr)
+        return;
+
+    tablebases = grown;
+    if (!add_to_tablebase_index(table.keys[COLOR_WHITE], tablebase_count)
+        || !add_to_tablebase_index(table.keys[COLOR_BLACK], tablebase_count))
+        return;
+
+    tablebases[tablebase_count++] = table;
+    if (table.piece_count > max_tablebase_piece_count)
+        max_tablebase_piece_count = table.piece_count;
+}
+
+// Adds the tables of which the WDL file is in `directory`.
+static void add_tablebases_in_directory(const char* directory) {
+    assert(directory != nullptr);
+
+    DIR* stream = opendir(directory);
+    if (stream == nullptr)
+        return;
+
+    static constexpr char WDL_EXTENSION[] = ".rtbw";
+    static constexpr size_t WDL_EXTENSION_LENGTH = sizeof(WDL_EXTENSION) - 1;
+
+    const struct dirent* entry;
+    while ((entry = readdir(stream)) != nullptr) {
+        const size_t length = strlen(entry->d_name);
+        if (length <= WDL_EXTENSION_LENGTH || length - WDL_EXTENSION_LENGTH >= TABLEBASE_NAME_MAX_LENGTH
+            || strcmp(entry->d_name + length - WDL_EXTENSION_LENGTH, WDL_EXTENSION) != 0)
+            continue;
+
+        char name[TABLEBASE_NAME_MAX_LENGTH];
+        memcpy(name, entry->d_name, length - WDL_EXTENSION_LENGTH);
+        name[length - WDL_EXTENSION_LENGTH] = '\0';
+        add_tablebase(name);
+    }
+
+    closedir(stream);
+}
+
+
+// Frees the decoding tables of `file` and unmaps it.
+static void free_tablebase_file(struct TablebaseFile* file) {
+    assert(file != nullptr);
+
+    for (size_t side = 0; side < COLOR_COUNT; ++side) {
+        for (size_t f = FILE_A; f <= FILE_D; ++f) {
+            free(file->pairs[side][f].base);
+            free(file->pairs[side][f].symbol_lengths);
+        }
+    }
+
+    if (file->mapping != nullptr)
+        munmap(file->mapping, file->mapping_size);
+}
+
+void free_tablebases() {
+    for (size_t i = 0; i < tablebase_count; ++i) {
+        free_tablebase_file(&tablebases[i].wdl);
+        free_tablebase_file(&tablebases[i].dtz);
+    }
+
+    free(tablebases);
+    tablebases                = nullptr;
+    tablebase_count           = 0;
+    max_tablebase_piece_count = 0;
+    memset(tablebase_index, 0, sizeof(tablebase_index));
+}
+
+size_t initialize_tablebases(const char* paths) {
+    assert(paths != nullptr);
+
+    call_once(&tablebase_once, initialize_tablebase_once);
+
+    free_tablebases();
+
+    if (strlen(paths) >= TABLEBASE_PATH_MAX_LENGTH) {
+        tablebase_paths[0] = '\0';
+        return 0;
+    }
+
+    strcpy(tablebase_paths, paths);
+
+    char directories[TABLEBASE_PATH_MAX_LENGTH];
+    strcpy(directories, paths);
+    char* state;
+    for (char* directory = strtok_r(directories, ":", &state); directory != nullptr;
+         directory       = strtok_r(nullptr, ":", &state))
+        add_tablebases_in_directory(directory);
+
+    return tablebase_count;
+}
+
+size_t tablebase_cardinality() {
+    return max_tablebase_piece_count;
+}
+
+
+// Maps the file `name` with `extension` from the first directory of the tablebase paths that has it. Returns a pointer
+// to the data after the magic number, or nullptr if the file could not be mapped or is not a valid table file.
+static const uint8_t* map_tablebase_file(struct TablebaseFile* file, const char* name, const char* extension,
+                                         const uint8_t magic[4]) {
+    assert(file != nullptr);
+    assert(name != nullptr);
+    assert(extension != nullptr);
+
+    char directories[TABLEBASE_PATH_MAX_LENGTH];
+    strcpy(directories, tablebase_paths);
+
+    int file_descriptor = -1;
+    char path[TABLEBASE_PATH_MAX_LENGTH + 2 * TABLEBASE_NAME_MAX_LENGTH];
+    char* state;
+    for (char* directory = strtok_r(directories, ":", &state); directory != nullptr && file_descriptor == -1;
+         directory       = strtok_r(nullptr, ":", &state)) {
+        snprintf(path, sizeof(path), "%s/%s%s", directory, name, extension);
+        file_descriptor = open(path, O_RDONLY);
+    }
+
+    if (file_descriptor == -1)
+        return nullptr;
+
+    struct stat file_status;
+    if (fstat(file_descriptor, &file_status) == -1 || file_status.st_size % 64 != 16) {
+        close(file_descriptor);
+        return nullptr;
+    }
+
+    // The mapping stays valid after closing the file.
+    const size_t size = (size_t)file_status.st_size;
+    void* mapping     = mmap(nullptr, size, PROT_READ, MAP_SHARED, file_descriptor, 0);
+    close(file_descriptor);
+    if (mapping == MAP_FAILED)
+        return nullptr;
+
+    if (memcmp(mapping, magic, 4) != 0) {
+        munmap(mapping, size);
+        return nullptr;
+    }
+
+    // Probes jump around in the file, so reading ahead is wasted.
+    madvise(mapping, size, MADV_RANDOM);
+
+    file->mapping      = mapping;
+    file->mapping_size = size;
+    return (const uint8_t*)mapping + 4;
+}
+
+// Returns the compressed table of `file` of `table` for side to move `side` and leading pawn file `file_index`.
+static INLINE struct PairsData* pairs_of(struct TablebaseFile* file, const struct Tablebase* table, const size_t side,
+                                         const size_t file_index) {
+    return &file->pairs[side % file->side_count][table->has_pawns ? file_index : 0];
+}
+
+// Computes the symbol lengths of `symbol` and its children, where the symbol length is the number of values a symbol
+// expands to minus 1.
+static uint8_t compute_symbol_length(struct PairsData* pairs, const size_t symbol, bool* visited) {
+    visited[symbol] = true;  // The tree is acyclic, so this can be set right away.
+
+    const uint16_t right = right_symbol(pairs, symbol);
+    if (right == 0xFFF)
+        return 0;
+
+    const uint16_t left = left_symbol(pairs, symbol);
+    if (!visited[left])
+        pairs->symbol_lengths[left] = compute_symbol_length(pairs, left, visited);
+    if (!visited[right])
+        pairs->symbol_lengths[right] = compute_symbol_length(pairs, right, visited);
+
+    return (uint8_t)(pairs->symbol_lengths[left] + pairs->symbol_lengths[right] + 1);
+}
+
+// Reads the sizes and the Huffman code of `pairs` from `data`. Returns a pointer to the data after them, or nullptr if
+// out of memory.
+static const uint8_t* read_pairs_sizes(struct PairsData* pairs, const uint8_t* data) {
+    pairs->flags = *data++;
+
+    if (pairs->flags & PAIRS_FLAG_SINGLE_VALUE) {
+        pairs->min_symbol_length = *data++;
+        return data;
+    }
+
+    // The group lengths end with a 0, at which the group index is the size of the table.
+    size_t group_count = 0;
+    while (pairs->group_length[group_count] != 0)
+        ++group_count;
+    const uint64_t table_size = pairs->group_index[group_count];
+
+    pairs->block_size         = (size_t)1 << *data++;
+    pairs->span               = (size_t)1 << *data++;
+    pairs->sparse_index_count = (size_t)((table_size + pairs->span - 1) / pairs->span);
+    const uint8_t padding     = *data++;
+    pairs->block_count        = read_le32(data);
+    data += 4;
+
+    // The block lengths are padded such that the sparse index never points past them.
+    pairs->block_length_count = pairs->block_count + padding;
+
+    const uint8_t max_symbol_length = *data++;
+    pairs->min_symbol_length        = *data++;
+    pairs->lowest_symbols           = data;
+
+    // Longer codes have lower values in a canonical Huffman code, so base[i] is the lowest code of length
+    // min_symbol_length + i, left aligned in 64 bits. The length of the code at the start of a buffer is then the first
+    // i for which the buffer is at least base[i].
+    const size_t base_count = (size_t)(max_symbol_length - pairs->min_symbol_length + 1);
+    pairs->base             = calloc(base_count, sizeof(*pairs->base));
+    if (pairs->base == nullptr)
+        return nullptr;
+
+    for (size_t i = base_count - 1; i-- > 0;) {
+        pairs->base[i] = (pairs->base[i + 1] + read_le16(pairs->lowest_symbols + 2 * i)
+                          - read_le16(pairs->lowest_symbols + 2 * (i + 1)))
+                       / 2;
+    }
+    for (size_t i = 0; i < base_count; ++i)
+        pairs->base[i] <<= 64 - i - pairs->min_symbol_length;
+
+    data += 2 * base_count;
+    const size_t symbol_count = read_le16(data);
+    data += 2;
+    pairs->tree = data;
+
+    pairs->symbol_lengths = calloc(symbol_count, sizeof(*pairs->symbol_lengths));
+    if (pairs->symbol_lengths == nullptr)
+        return nullptr;
+
+    // The values are compressed by recursive pairing, which repeatedly replaces the most frequent pair of adjacent
+    // symbols by a new symbol.
+    bool visited[1 << 12] = {false};
+    for (size_t symbol = 0; symbol < symbol_count; ++symbol) {
+        if (!visited[symbol])
+            pairs->symbol_lengths[symbol] = compute_symbol_length(pairs, symbol, visited);
+    }
+
+    return data + 3 * symbol_count + (symbol_count & 1);
+}
+
+// Divides the pieces of `pairs` of `table` into groups and computes the index multiplier of every group, given the
+// order of the groups in `order` and the file of the leading pawn `file_index`.
+static void set_groups(const struct Tablebase* table, struct PairsData* pairs, const int order[2],
+                       const size_t file_index) {
+    // The leading group consists of the leading pawns, or the first 3 pieces if there are unique pieces, or else the
+    // two kings. Other groups consist of equal pieces.
+    int first_length     = table->has_pawns ? 0 : table->has_unique_pieces ? 3 : 2;
+    size_t group         = 0;
+    pairs->group_length[0] = 1;
+    for (size_t i = 1; i < table->piece_count; ++i) {
+        if (--first_length > 0 || pairs->pieces[i] == pairs->pieces[i - 1])
+            ++pairs->group_length[group];
+        else
+            pairs->group_length[++group] = 1;
+    }
+    pairs->group_length[++group] = 0;
+
+    // The groups are encoded as g1 * N(g2) * N(g3) + g2 * N(g3) + g3, where N(g) is the number of placements of group
+    // g, in the order of the table. The leading group is at order[0] and the remaining pawns, if any, at order[1].
+    const bool pawns_on_both_sides = table->has_pawns && table->pawn_counts[1] > 0;
+    size_t next                    = pawns_on_both_sides ? 2 : 1;
+    size_t free_squares = (size_t)SQUARE_COUNT - pairs->group_length[0];
+    if (pawns_on_both_sides)
+        free_squares -= pairs->group_length[1];
+
+    uint64_t index = 1;
+    for (int k = 0; next < group || k == order[0] || k == order[1]; ++k) {
+        if (k == order[0]) {
+            pairs->group_index[0] = index;
+            index *= table->has_pawns ? lead_pawns_size[pairs->group_length[0]][file_index]
+                   : table->has_unique_pieces ? 31332
+                                              : 462;
+        } else if (k == order[1]) {
+            pairs->group_index[1] = index;
+            index *= binomial[pairs->group_length[1]][48 - pairs->group_length[0]];
+        } else {
+            pairs->group_index[next] = index;
+            index *= binomial[pairs->group_length[next]][free_squares];
+            free_squares -= pairs->group_length[next++];
+        }
+    }
+
+    pairs->group_index[group] = index;
+}
+
+// Reads the value maps of the DTZ `file` of `table` from `data`. Returns a pointer to the data after them.
+static const uint8_t* read_dtz_map(struct TablebaseFile* file, const struct Tablebase* table, const uint8_t* data,
+                                   const size_t max_file) {
+    file->dtz_map = data;
+
+    for (size_t f = FILE_A; f <= max_file; ++f) {
+        struct PairsData* pairs = pairs_of(file, table, 0, f);
+        if (!(pairs->flags & PAIRS_FLAG_MAPPED))
+            continue;
+
+        if (pairs->flags & PAIRS_FLAG_WIDE) {
+            data += (uintptr_t)data & 1;
+            for (size_t i = 0; i < 4; ++i) {
+                pairs->map_index[i] = (uint16_t)((size_t)(data - file->dtz_map) / 2 + 1);
+                data += 2 * (size_t)read_le16(data) + 2;
+            }
+        } else {
+            for (size_t i = 0; i < 4; ++i) {
+                pairs->map_index[i] = (uint16_t)(data - file->dtz_map + 1);
+                data += *data + 1;
+            }
+        }
+    }
+
+    return data + ((uintptr_t)data & 1);
+}
+
+// Sets up `file` of `table` from its mapped `data`. Returns whether the file matches the table.
+static bool read_tablebase_file(struct TablebaseFile* file, const struct Tablebase* table, const uint8_t* data,
+                                const bool is_dtz) {
+    enum { SPLIT = 1, HAS_PAWNS = 2 };
+
+    const bool split = table->keys[COLOR_WHITE] != table->keys[COLOR_BLACK];
+    if (table->has_pawns != ((*data & HAS_PAWNS) != 0) || (!is_dtz && split != ((*data & SPLIT) != 0)))
+        return false;
+    ++data;
+
+    file->side_count               = (!is_dtz && split) ? 2 : 1;
+    const size_t max_file          = table->has_pawns ? FILE_D : FILE_A;
+    const bool pawns_on_both_sides = table->has_pawns && table->pawn_counts[1] > 0;
+
+    for (size_t f = FILE_A; f <= max_file; ++f) {
+        const int order[COLOR_COUNT][2] = {
+            {data[0] & 0xF, pawns_on_both_sides ? data[1] & 0xF : 0xF},
+            {data[0] >> 4, pawns_on_both_sides ? data[1] >> 4 : 0xF}
+        };
+        data += 1 + pawns_on_both_sides;
+
+        for (size_t k = 0; k < table->piece_count; ++k, ++data) {
+            for (size_t side = 0; side < file->side_count; ++side)
+                pairs_of(file, table, side, f)->pieces[k] = (uint8_t)((side == 0) ? (*data & 0xF) : (*data >> 4));
+        }
+
+        for (size_t side = 0; side < file->side_count; ++side)
+            set_groups(table, pairs_of(file, table, side, f), order[side], f);
+    }
+
+    data += (uintptr_t)data & 1;
+
+    for (size_t f = FILE_A; f <= max_file; ++f) {
+        for (size_t side = 0; side < file->side_count; ++side) {
+            data = read_pairs_sizes(pairs_of(file, table, side, f), data);
+            if (data == nullptr)
+                return false;
+        }
+    }
+
+    if (is_dtz)
+        data = read_dtz_map(file, table, data, max_file);
+
+    for (size_t f = FILE_A; f <= max_file; ++f) {
+        for (size_t side = 0; side < file->side_count; ++side) {
+            struct PairsData* pairs = pairs_of(file, table, side, f);
+            pairs->sparse_index     = data;
+            data += 6 * pairs->sparse_index_count;
+        }
+    }
+
+    for (size_t f = FILE_A; f <= max_file; ++f) {
+        for (size_t side = 0; side < file->side_count; ++side) {
+            struct PairsData* pairs = pairs_of(file, table, side, f);
+            pairs->block_lengths    = data;
+            data += 2 * pairs->block_length_count;
+        }
+    }
+
+    for (size_t f = FILE_A; f <= max_file; ++f) {
+        for (size_t side = 0; side < file->side_count; ++side) {
+            struct PairsData* pairs = pairs_of(file, table, side, f);
+            data += (64 - ((uintptr_t)data & 63)) & 63;
+            pairs->data = data;
+            data += pairs->block_count * pairs->block_size;
+        }
+    }
+
+    return true;
+}
+
+// Returns whether the WDL or DTZ `file` of `table` is mapped, mapping it if this is the first probe.
+static bool ensure_mapped(struct Tablebase* table, const bool is_dtz) {
+    struct TablebaseFile* file = is_dtz ? &table->dtz : &table->wdl;
+    if (atomic_load(&file->ready))
+        return file->mapping != nullptr;
+
+    mtx_lock(&mapping_mutex);
+
+    if (!atomic_load(&file->ready)) {
+        const uint8_t* data = map_tablebase_file(file, table->name, is_dtz ? ".rtbz" : ".rtbw",
+                                                 is_dtz ? DTZ_MAGIC : WDL_MAGIC);
+        if (data != nullptr && !read_tablebase_file(file, table, data, is_dtz)) {
+            munmap(file->mapping, file->mapping_size);
+            file->mapping = nullptr;
+        }
+
+        atomic_store(&file->ready, true);
+    }
+
+    mtx_unlock(&mapping_mutex);
+
+    return file->mapping != nullptr;
+}
+
+
+// Returns the value at `index` in the compressed table `pairs`.
+static int decompress_pairs(const struct PairsData* pairs, const uint64_t index) {
+    if (pairs->flags & PAIRS_FLAG_SINGLE_VALUE)
+        return pairs->min_symbol_length;
+
+    // Every block stores block length + 1 values. The sparse index stores, for every span of indices, the block and
+    // the offset in that block of the middle of the span. From there we walk to the block that contains `index`.
+    const uint8_t* sparse_entry = pairs->sparse_index + 6 * (index / pairs->span);
+    size_t block                = read_le32(sparse_entry);
+    int64_t offset = read_le16(sparse_entry + 4) + (int64_t)(index % pairs->span) - (int64_t)(pairs->span / 2);
+
+    while (offset < 0)
+        offset += read_le16(pairs->block_lengths + 2 * --block) + 1;
+
+    while (offset > read_le16(pairs->block_lengths + 2 * block))
+        offset -= read_le16(pairs->block_lengths + 2 * block++) + 1;
+
+    // Decode the Huffman codes of the block until we reach the symbol that contains the value at `offset`.
+    const uint8_t* data = pairs->data + block * pairs->block_size;
+    uint64_t buffer     = read_be64(data);
+    size_t buffer_size  = 64;
+    data += 8;
+
+    size_t symbol;
+    while (true) {
+        size_t length = 0;
+        while (buffer < pairs->base[length])
+            ++length;
+
+        symbol = (size_t)((buffer - pairs->base[length]) >> (64 - length - pairs->min_symbol_length));
+        symbol += read_le16(pairs->lowest_symbols + 2 * length);
+
+        if (offset < pairs->symbol_lengths[symbol] + 1)
+            break;
+
+        offset -= pairs->symbol_lengths[symbol] + 1;
+        length += pairs->min_symbol_length;
+        buffer <<= length;
+        buffer_size -= length;
+
+        if (buffer_size <= 32) {
+            buffer_size += 32;
+            buffer |= (uint64_t)read_be32(data) << (64 - buffer_size);
+            data += 4;
+        }
+    }
+
+    // The symbol expands to multiple values, the one at `offset` is found by descending the pairing tree.
+    while (pairs->symbol_lengths[symbol] != 0) {
+        const uint16_t left = left_symbol(pairs, symbol);
+        if (offset < pairs->symbol_lengths[left] + 1) {
+            symbol = left;
+        } else {
+            offset -= pairs->symbol_lengths[left] + 1;
+            symbol = right_symbol(pairs, symbol);
+        }
+    }
+
+    return left_symbol(pairs, symbol);
+}
+
+// Converts the stored DTZ `value` of `table` with leading pawn file `file_index` for a position with outcome `wdl` to
+// plies.
+static int map_dtz_value(struct Tablebase* table, const size_t file_index, int value, const enum WdlScore wdl) {
+    static constexpr size_t WDL_TO_MAP[] = {1, 3, 0, 2, 0};
+
+    const struct PairsData* pairs = pairs_of(&table->dtz, table, 0, file_index);
+    if (pairs->flags & PAIRS_FLAG_MAPPED) {
+        const size_t index = pairs->map_index[WDL_TO_MAP[wdl + 2]] + (size_t)value;
+        value = (pairs->flags & PAIRS_FLAG_WIDE) ? read_le16(table->dtz.dtz_map + 2 * index)
+                                                 : table->dtz.dtz_map[index];
+    }
+
+    // Values are stored in moves rather than plies, unless the table says otherwise.
+    if ((wdl == WDL_WIN && !(pairs->flags & PAIRS_FLAG_WIN_PLIES))
+        || (wdl == WDL_LOSS && !(pairs->flags & PAIRS_FLAG_LOSS_PLIES)) || wdl == WDL_CURSED_WIN
+        || wdl == WDL_BLESSED_LOSS)
+        value *= 2;
+
+    return value + 1;
+}
+
+// Sorts the `count` squares in `squares` in ascending order of `keys`, or of the squares themselves if `keys` is
+// nullptr. Squares with equal keys keep their order.
+static void sort_squares(int* squares, const size_t count, const int* keys) {
+    for (size_t i = 1; i < count; ++i) {
+        const int square = squares[i];
+        const int key    = (keys != nullptr) ? keys[square] : square;
+
+        size_t j = i;
+        for (; j > 0 && ((keys != nullptr) ? keys[squares[j - 1]] : squares[j - 1]) > key; --j)
+            squares[j] = squares[j - 1];
+        squares[j] = square;
+    }
+}
+
+// Probes the WDL or DTZ file of `table` for `position`. For a DTZ probe, `wdl` is the outcome of the position. Returns
+// the WDL score or the DTZ value in plies.
+static int probe_table(const struct Position* position, struct Tablebase* table, const bool is_dtz,
+                       const enum WdlScore wdl, enum ProbeState* state) {
+    struct TablebaseFile* file = is_dtz ? &table->dtz : &table->wdl;
+
+    // The tables are stored with the stronger side as white. Symmetric tables only store white to move. Otherwise the
+    // position is looked up with the colors swapped and the board flipped vertically.
+    const bool symmetric_black_to_move = table->keys[COLOR_WHITE] == table->keys[COLOR_BLACK]
+                                      && position->side_to_move == COLOR_BLACK;
+    const bool black_stronger = material_key(position) != table->keys[COLOR_WHITE];
+    const bool flip           = symmetric_black_to_move || black_stronger;
+    const uint8_t flip_color  = flip ? 8 : 0;
+    const int flip_squares    = flip ? 56 : 0;
+    const size_t side         = (size_t)flip ^ (size_t)position->side_to_move;
+
+    int squares[TABLEBASE_MAX_PIECES];
+    uint8_t pieces[TABLEBASE_MAX_PIECES];
+    size_t size             = 0;
+    size_t lead_pawn_count  = 0;
+    size_t file_index       = FILE_A;
+    Bitboard lead_pawns     = EMPTY_BITBOARD;
+
+    // Tables with pawns are split by the file of the leading pawn, which is the pawn with the highest map_pawns value.
+    // The leading pawns all have the color of the first piece in the encoding.
+    if (table->has_pawns) {
+        const uint8_t lead_piece = (uint8_t)(pairs_of(file, table, 0, 0)->pieces[0] ^ flip_color);
+        assert((lead_piece & 7) == PIECE_TYPE_PAWN + 1);
+
+        lead_pawns    = piece_occupancy(position, (enum Color)(lead_piece >> 3), PIECE_TYPE_PAWN);
+        Bitboard pawns = lead_pawns;
+        while (pawns != EMPTY_BITBOARD)
+            squares[size++] = pop_lsb64(&pawns) ^ flip_squares;
+
+        lead_pawn_count = size;
+
+        size_t lead = 0;
+        for (size_t i = 1; i < lead_pawn_count; ++i) {
+            if (map_pawns[squares[i]] > map_pawns[squares[lead]])
+                lead = i;
+        }
+        const int lead_square = squares[lead];
+        squares[lead]         = squares[0];
+        squares[0]            = lead_square;
+
+        file_index = (size_t)(((lead_square & 7) < FILE_E) ? (lead_square & 7) : FILE_H - (lead_square & 7));
+    }
+
+    // DTZ tables store only one side to move, the other side has to be resolved by the caller with a 1 ply search.
+    if (is_dtz) {
+        const uint8_t flags = pairs_of(file, table, side, file_index)->flags;
+        if ((flags & PAIRS_FLAG_SIDE_TO_MOVE) != side
+            && (table->keys[COLOR_WHITE] != table->keys[COLOR_BLACK] || table->has_pawns)) {
+            *state = PROBE_CHANGE_SIDE_TO_MOVE;
+            return 0;
+        }
+    }
+
+    Bitboard remaining = position->total_occupancy ^ lead_pawns;
+    while (remaining != EMPTY_BITBOARD) {
+        const int square = pop_lsb64(&remaining);
+        squares[size]    = square ^ flip_squares;
+        pieces[size++]   = (uint8_t)(tablebase_piece(piece_on_square(position, (enum Square)square)) ^ flip_color);
+    }
+
+    const struct PairsData* pairs = pairs_of(file, table, side, file_index);
+
+    // Order the pieces like the encoding of the table.
+    for (size_t i = lead_pawn_count; i + 1 < size; ++i) {
+        for (size_t j = i + 1; j < size; ++j) {
+            if (pairs->pieces[i] == pieces[j]) {
+                const uint8_t piece = pieces[i];
+                const int square    = squares[i];
+                pieces[i]           = pieces[j];
+                squares[i]          = squares[j];
+                pieces[j]           = piece;
+                squares[j]          = square;
+                break;
+            }
+        }
+    }
+
+    // Mirror the board horizontally such that the leading piece is on files a-d.
+    if ((squares[0] & 7) > FILE_D) {
+        for (size_t i = 0; i < size; ++i)
+            squares[i] ^= 7;
+    }
+
+    uint64_t index;
+    if (table->has_pawns) {
+        index = lead_pawn_index[lead_pawn_count][squares[0]];
+
+        sort_squares(squares + 1, lead_pawn_count - 1, map_pawns);
+        for (size_t i = 1; i < lead_pawn_count; ++i)
+            index += binomial[i][map_pawns[squares[i]]];
+    } else {
+        // Without pawns, the board is also mirrored vertically and diagonally, such that the leading piece is in the
+        // a1-d1-d4 triangle and the first leading piece off the diagonal is below it.
+        if ((squares[0] >> 3) > RANK_4) {
+            for (size_t i = 0; i < size; ++i)
+                squares[i] ^= 56;
+        }
+
+        for (size_t i = 0; i < pairs->group_length[0]; ++i) {
+            if (off_diagonal(squares[i]) == 0)
+                continue;
+
+            if (off_diagonal(squares[i]) > 0) {
+                for (size_t j = i; j < size; ++j)
+                    squares[j] = ((squares[j] >> 3) | (squares[j] << 3)) & 63;
+            }
+            break;
+        }
+
+        if (table->has_unique_pieces) {
+            // The first 3 pieces are encoded together in 31332 ways, depending on which of them are on the diagonal.
+            const int adjust1 = squares[1] > squares[0];
+            const int adjust2 = (squares[2] > squares[0]) + (squares[2] > squares[1]);
+
+            if (off_diagonal(squares[0]) != 0) {
+                index = (uint64_t)((map_a1d1d4[squares[0]] * 63 + (squares[1] - adjust1)) * 62 + squares[2] - adjust2);
+            } else if (off_diagonal(squares[1]) != 0) {
+                index = (uint64_t)((6 * 63 + (squares[0] >> 3) * 28 + map_b1h1h7[squares[1]]) * 62 + squares[2]
+                                   - adjust2);
+            } else if (off_diagonal(squares[2]) != 0) {
+                index = (uint64_t)(6 * 63 * 62 + 4 * 28 * 62 + (squares[0] >> 3) * 7 * 28
+                                   + ((squares[1] >> 3) - adjust1) * 28 + map_b1h1h7[squares[2]]);
+            } else {
+                index = (uint64_t)(6 * 63 * 62 + 4 * 28 * 62 + 4 * 7 * 28 + (squares[0] >> 3) * 7 * 6
+                                   + ((squares[1] >> 3) - adjust1) * 6 + ((squares[2] >> 3) - adjust2));
+            }
+        } else {
+            index = (uint64_t)map_kk[map_a1d1d4[squares[0]]][squares[1]];
+        }
+    }
+
+    // The other groups are encoded by the combination of their squares, skipping the squares of earlier groups.
+    index *= pairs->group_index[0];
+    int* group           = squares + pairs->group_length[0];
+    bool remaining_pawns = table->has_pawns && table->pawn_counts[1] > 0;
+    for (size_t next = 1; pairs->group_length[next] != 0; ++next) {
+        sort_squares(group, pairs->group_length[next], nullptr);
+
+        uint64_t group_value = 0;
+        for (size_t i = 0; i < pairs->group_length[next]; ++i) {
+            int adjust = 0;
+            for (const int* square = squares; square < group; ++square)
+                adjust += group[i] > *square;
+
+            group_value += binomial[i + 1][group[i] - adjust - (remaining_pawns ? 8 : 0)];
+        }
+
+        remaining_pawns = false;
+        index += group_value * pairs->group_index[next];
+        group += pairs->group_length[next];
+    }
+
+    const int value = decompress_pairs(pairs, index);
+    return is_dtz ? map_dtz_value(table, file_index, value, wdl) : value - 2;
+}
+
+// Probes the WDL or DTZ table of `position`. For a DTZ probe, `wdl` is the outcome of the position.
+static int probe_tables(const struct Position* position, const bool is_dtz, const enum WdlScore wdl,
+                        enum ProbeState* state) {
+    if (popcount64(position->total_occupancy) == 2)
+        return WDL_DRAW;  // Only the kings are left.
+
+    struct Tablebase* table = find_tablebase(material_key(position));
+    if (table == nullptr || !ensure_mapped(table, is_dtz)) {
+        *state = PROBE_FAILED;
+        return 0;
+    }
+
+    return probe_table(position, table, is_dtz, wdl, state);
+}
+
+
+// Returns whether `move` resets the 50 move counter in `position`.
+static INLINE bool is_zeroing_move(const struct Position* position, const Move move) {
+    return is_capture(position, move) || type_of_piece(piece_on_square(position, move_source(move))) == PIECE_TYPE_PAWN;
+}
+
+// Returns the outcome of `position`. The tables may store any value for positions where the side to move wins by a
+// capture, and may store a loss where a capture draws, as that compresses better. They also ignore en passant. So the
+// captures, and pawn moves if `check_zeroing_moves` is set, are searched first and the best outcome is returned. If the
+// best outcome comes from such a move, `state` is set to PROBE_ZEROING_BEST_MOVE.
+static enum WdlScore search_zeroing_moves(struct Position* position, const bool check_zeroing_moves,
+                                          enum ProbeState* state) {
+    Move move_list[MAX_MOVES];
+    const size_t move_count = generate_legal_moves(position, move_list);
+
+    enum WdlScore best_value = WDL_LOSS;
+    size_t searched_count    = 0;
+
+    struct PositionInfo info;
+    for (size_t i = 0; i < move_count; ++i) {
+        const Move move = move_list[i];
+        if (!is_capture(position, move)
+            && (!check_zeroing_moves || type_of_piece(piece_on_square(position, move_source(move))) != PIECE_TYPE_PAWN))
+            continue;
+
+        ++searched_count;
+
+        do_move(position, &info, move);
+        const enum WdlScore value = (enum WdlScore)-search_zeroing_moves(position, false, state);
+        undo_move(position, move);
+
+        if (*state == PROBE_FAILED)
+            return WDL_DRAW;
+
+        if (value > best_value) {
+            best_value = value;
+            if (value >= WDL_WIN) {
+                *state = PROBE_ZEROING_BEST_MOVE;
+                return value;
+            }
+        }
+    }
+
+    // If all moves have been searched, the stored value can be wrong, for example when the only move is en passant.
+    const bool all_moves_searched = searched_count > 0 && searched_count == move_count;
+
+    enum WdlScore value = best_value;
+    if (!all_moves_searched) {
+        value = (enum WdlScore)probe_tables(position, false, WDL_DRAW, state);
+        if (*state == PROBE_FAILED)
+            return WDL_DRAW;
+    }
+
+    if (best_value >= value) {
+        *state = (best_value > WDL_DRAW || all_moves_searched) ? PROBE_ZEROING_BEST_MOVE : PROBE_OK;
+        return best_value;
+    }
+
+    *state = PROBE_OK;
+    return value;
+}
+
+// Returns the DTZ of a position with outcome `wdl` right before a zeroing move.
+static INLINE int dtz_before_zeroing(const enum WdlScore wdl) {
+    switch (wdl) {
+        case WDL_WIN:
+            return 1;
+        case WDL_CURSED_WIN:
+            return 101;
+        case WDL_BLESSED_LOSS:
+            return -101;
+        case WDL_LOSS:
+            return -1;
+        default:
+            return 0;
+    }
+}
+
+// Returns the sign of `x`.
+static INLINE int sign(const int x) {
+    return (x > 0) - (x < 0);
+}
+
+bool probe_wdl(struct Position* position, enum WdlScore* wdl) {
+    assert(position != nullptr);
+    assert(wdl != nullptr);
+    assert(position->info->castling_rights == CASTLE_NONE);
+
+    enum ProbeState state = PROBE_OK;
+    *wdl                  = search_zeroing_moves(position, false, &state);
+    return state != PROBE_FAILED;
+}
+
+// Returns the DTZ of `position`, see probe_dtz().
+static int probe_dtz_state(struct Position* position, enum ProbeState* state) {
+    *state                = PROBE_OK;
+    const enum WdlScore wdl = search_zeroing_moves(position, true, state);
+
+    // DTZ tables do not store draws.
+    if (*state == PROBE_FAILED || wdl == WDL_DRAW)
+        return 0;
+
+    // The DTZ tables store no useful value if the best move is a zeroing move.
+    if (*state == PROBE_ZEROING_BEST_MOVE)
+        return dtz_before_zeroing(wdl);
+
+    int dtz = probe_tables(position, true, wdl, state);
+    if (*state == PROBE_FAILED)
+        return 0;
+
+    if (*state != PROBE_CHANGE_SIDE_TO_MOVE)
+        return (dtz + ((wdl == WDL_BLESSED_LOSS || wdl == WDL_CURSED_WIN) ? 100 : 0)) * sign(wdl);
+
+    // The table stores the other side to move, so we search 1 ply for the move with the best DTZ.
+    Move move_list[MAX_MOVES];
+    const size_t move_count = generate_legal_moves(position, move_list);
+
+    int best_dtz = INT_MAX;
+
+    struct PositionInfo info;
+    for (size_t i = 0; i < move_count; ++i) {
+        const Move move    = move_list[i];
+        const bool zeroing = is_zeroing_move(position, move);
+
+        do_move(position, &info, move);
+
+        // For zeroing moves we want the DTZ before the move, but we need the outcome after it, as even a winning
+        // position can have a losing or drawing capture.
+        dtz = zeroing ? -dtz_before_zeroing(search_zeroing_moves(position, false, state))
+                      : -probe_dtz_state(position, state);
+
+        // A mating move has a DTZ of 1.
+        Move reply_list[MAX_MOVES];
+        if (dtz == 1 && in_check(position) && generate_legal_moves(position, reply_list) == 0)
+            best_dtz = 1;
+
+        if (!zeroing)
+            dtz += sign(dtz);
+
+        if (dtz < best_dtz && sign(dtz) == sign(wdl))
+            best_dtz = dtz;
+
+        undo_move(position, move);
+
+        if (*state == PROBE_FAILED)
+            return 0;
+    }
+
+    // Without legal moves the position is mate.
+    return (best_dtz == INT_MAX) ? -1 : best_dtz;
+}
+
+bool probe_dtz(struct Position* position, int* dtz) {
+    assert(position != nullptr);
+    assert(dtz != nullptr);
+    assert(position->info->castling_rights == CASTLE_NONE);
+
+    enum ProbeState state;
+    *dtz = probe_dtz_state(position, &state);
+    return state != PROBE_FAILED;
+}
+
+
+// Returns whether a position has repeated since the last zeroing move in the history of `position`.
+static bool has_repeated(const struct Position* position) {
+    const struct PositionInfo* info = position->info;
+    size_t plies = (info->halfmove_clock < position->plies_since_start) ? info->halfmove_clock
+                                                                        : position->plies_since_start;
+    while (info != nullptr) {
+        if (info->repetition != 0)
+            return true;
+
+        if (plies-- == 0)
+            break;
+
+        info = info->previous_info;
+    }
+
+    return false;
+}
+
+// Ranks the `move_count` moves in `moves` of `position` by their DTZ, counting from the root. Wins within the 50 move
+// rule, and without repetitions since the last zeroing move, are ranked equally. Closer wins are ranked higher
+// otherwise, and losses the other way around. Returns whether all moves could be ranked.
+static bool rank_root_moves_by_dtz(struct Position* position, const Move* moves, const size_t move_count,
+                                   int* ranks) {
+    const int halfmove_clock = (int)position->info->halfmove_clock;
+    const bool repeated      = has_repeated(position);
+
+    enum ProbeState state = PROBE_OK;
+    struct PositionInfo info;
+    for (size_t i = 0; i < move_count; ++i) {
+        do_move(position, &info, moves[i]);
+
+        int dtz;
+        if (position->info->halfmove_clock == 0) {
+            dtz = dtz_before_zeroing((enum WdlScore)-search_zeroing_moves(position, false, &state));
+        } else if (is_draw(position, 1)) {
+            dtz = 0;
+        } else {
+            dtz = -probe_dtz_state(position, &state);
+            dtz += sign(dtz);
+        }
+
+        Move reply_list[MAX_MOVES];
+        if (dtz == 2 && in_check(position) && generate_legal_moves(position, reply_list) == 0)
+            dtz = 1;
+
+        undo_move(position, moves[i]);
+
+        if (state == PROBE_FAILED)
+            return false;
+
+        if (dtz > 0)
+            ranks[i] = (dtz + halfmove_clock <= 99 && !repeated) ? MAX_DTZ : MAX_DTZ - (dtz + halfmove_clock);
+        else if (dtz < 0)
+            ranks[i] = (-2 * dtz + halfmove_clock < 100) ? -MAX_DTZ : -MAX_DTZ + (-dtz + halfmove_clock);
+        else
+            ranks[i] = 0;
+    }
+
+    return true;
+}
+
+// Ranks the `move_count` moves in `moves` of `position` by their outcome. Returns whether all moves could be ranked.
+static bool rank_root_moves_by_wdl(struct Position* position, const Move* moves, const size_t move_count,
+                                   int* ranks) {
+    static constexpr int WDL_TO_RANK[] = {-MAX_DTZ, -MAX_DTZ + 101, 0, MAX_DTZ - 101, MAX_DTZ};
+
+    enum ProbeState state = PROBE_OK;
+    struct PositionInfo info;
+    for (size_t i = 0; i < move_count; ++i) {
+        do_move(position, &info, moves[i]);
+        const enum WdlScore wdl = (enum WdlScore)-search_zeroing_moves(position, false, &state);
+        undo_move(position, moves[i]);
+
+        if (state == PROBE_FAILED)
+            return false;
+
+        ranks[i] = WDL_TO_RANK[wdl + 2];
+    }
+
+    return true;
+}
+
+bool filter_root_moves(struct Position* position, Move moves[static MAX_MOVES], size_t* move_count,
+                       bool* probe_in_search) {
+    assert(position != nullptr);
+    assert(moves != nullptr);
+    assert(move_count != nullptr);
+    assert(probe_in_search != nullptr);
+    assert(position->info->castling_rights == CASTLE_NONE);
+
+    int ranks[MAX_MOVES];
+    const bool dtz_available = rank_root_moves_by_dtz(position, moves, *move_count, ranks);
+    if (!dtz_available && !rank_root_moves_by_wdl(position, moves, *move_count, ranks))
+        return false;
+
+    int best_rank = -MAX_DTZ;
+    for (size_t i = 0; i < *move_count; ++i) {
+        if (ranks[i] > best_rank)
+            best_rank = ranks[i];
+    }
+
+    size_t kept_count = 0;
+    for (size_t i = 0; i < *move_count; ++i) {
+        if (ranks[i] == best_rank)
+            moves[kept_count++] = moves[i];
+    }
+
+    *move_count      = kept_count;
+    *probe_in_search = !dtz_available && best_rank > 0;
+    return true;
+}
@@ -0,0 +1,59 @@
+#ifndef WINDMOLEN_SYZYGY_H_
+#define WINDMOLEN_SYZYGY_H_
+
+
+#include <stddef.h>
+
+#include "constants.h"
+#include "move.h"
+#include "position.h"
+
+
+
+// The largest number of pieces, kings included, in a Syzygy table.
+static constexpr size_t TABLEBASE_MAX_PIECES = 7;
+
+// The outcome of a position for the side to move under the 50 move rule. A cursed win is a win that cannot be forced
+// within 50 moves without a capture or pawn move, so it is a draw under the 50 move rule. A blessed loss is its
+// counterpart for the losing side.
+enum WdlScore {
+    WDL_LOSS         = -2,
+    WDL_BLESSED_LOSS = -1,
+    WDL_DRAW         = 0,
+    WDL_CURSED_WIN   = 1,
+    WDL_WIN          = 2
+};
+
+
+// Looks for Syzygy tables in the directories of `paths`, separated by colons, and replaces the previously found tables
+// by them. The table files are memory mapped the first time they are probed and shared by all threads. Returns the
+// number of WDL tables found.
+size_t initialize_tablebases(const char* paths);
+
+// Unmaps and forgets all tables.
+void free_tablebases();
+
+// Returns the largest number of pieces of the tables found, or 0 if there are none.
+size_t tablebase_cardinality();
+
+// Probes the WDL tables for `position`, which must have no castling rights and at most tablebase_cardinality() pieces.
+// Returns whether the probe succeeded, in which case the outcome for the side to move is stored in `wdl`.
+bool probe_wdl(struct Position* position, enum WdlScore* wdl);
+
+// Probes the DTZ tables for `position`, which must have no castling rights and at most tablebase_cardinality() pieces.
+// Returns whether the probe succeeded, in which case the number of plies to the next capture or pawn move on the
+// optimal path is stored in `dtz`. It is positive for a win, negative for a loss and 0 for a draw. Cursed wins and
+// blessed losses are 100 plies further away than the 50 move rule allows.
+bool probe_dtz(struct Position* position, int* dtz);
+
+// Ranks the `move_count` root moves in `moves` of `position` with the DTZ tables, or with the WDL tables if the DTZ
+// tables are missing. Only the best ranked root moves are kept, in their original order, and `move_count` is updated.
+// Returns whether the root moves could be ranked, in which case `probe_in_search` tells whether probing the WDL tables
+// during the search is still useful. That is only the case if the root is won and the DTZ tables are missing, as
+// without them all winning moves look alike.
+bool filter_root_moves(struct Position* position, Move moves[static MAX_MOVES], size_t* move_count,
+                       bool* probe_in_search);
+
+
+
+#endif /* #ifndef WINDMOLEN_SYZYGY_H_ */
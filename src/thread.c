@@ -9,11 +9,18 @@
 #include <threads.h>
 
 #include "engine.h"
+#include "eval_cache.h"
+#include "material.h"
 #include "move.h"
 #include "move_generation.h"
 #include "move_picker.h"
+#include "nnue.h"
+#include "pawns.h"
+#include "score.h"
 #include "search.h"
+#include "syzygy.h"
 #include "time_manager.h"
+#include "util.h"
 
 
 
@@ -36,6 +43,70 @@ void wait_until_finished_searching(struct ThreadPool* thread_pool, const bool wa
         wait_until_thread_finished_searching(&thread_pool->threads[i]);
 }
 
+
+bool claim_nodes(struct Searcher* searcher) {
+    assert(searcher != nullptr);
+
+    constexpr uint64_t MAX_NODE_CLAIM = 1024;
+
+    struct ThreadPool* thread_pool = searcher->thread_pool;
+
+    uint64_t nodes_claimed = atomic_load(&thread_pool->nodes_claimed);
+    uint64_t claim;
+    do {
+        const uint64_t node_limit = atomic_load(&thread_pool->node_limit);
+        if (nodes_claimed >= node_limit) {
+            atomic_store(&thread_pool->stop_search, true);
+            atomic_store(&thread_pool->search_aborted, true);
+            return false;
+        }
+
+        // The claims get smaller as the limit comes closer, such that few claimed nodes are left unused by the other
+        // searchers once the limit is reached.
+        claim = (node_limit - nodes_claimed) / (2 * thread_pool->thread_count);
+        if (claim > MAX_NODE_CLAIM)
+            claim = MAX_NODE_CLAIM;
+        if (claim == 0)
+            claim = 1;
+    } while (!atomic_compare_exchange_weak(&thread_pool->nodes_claimed, &nodes_claimed, nodes_claimed + claim));
+
+    searcher->node_budget = claim;
+    return true;
+}
+
+void update_node_limit(struct ThreadPool* thread_pool) {
+    assert(thread_pool != nullptr);
+
+    uint64_t node_limit = thread_pool->search_arguments->max_search_nodes;
+
+    // The time manager is only up to date if the search is limited by time and we are not pondering.
+    if (!thread_pool->search_arguments->infinite_search && !atomic_load(&thread_pool->pondering)
+        && thread_pool->time_manager->cutoff_nodes < node_limit)
+        node_limit = thread_pool->time_manager->cutoff_nodes;
+
+    atomic_store(&thread_pool->node_limit, node_limit);
+}
+
+size_t total_nodes_searched(const struct ThreadPool* thread_pool) {
+    assert(thread_pool != nullptr);
+
+    size_t nodes_searched = 0;
+    for (size_t i = 0; i < thread_pool->thread_count; ++i)
+        nodes_searched += atomic_load(&thread_pool->threads[i].searcher.nodes_searched);
+
+    return nodes_searched;
+}
+
+uint64_t total_tablebase_hits(const struct ThreadPool* thread_pool) {
+    assert(thread_pool != nullptr);
+
+    uint64_t tablebase_hits = 0;
+    for (size_t i = 0; i < thread_pool->thread_count; ++i)
+        tablebase_hits += atomic_load(&thread_pool->threads[i].searcher.tablebase_hits);
+
+    return tablebase_hits;
+}
+
 // The main thread loop. This is the function that gets executed when starting a new thread (`thread_`). The thread
 // stays in a waiting loop until it is signaled by the engine thread that it needs to start searching. It will then
 // start its searcher. When `start_searcher` has finished, the thread returns to the waiting loop and awaits a new
@@ -53,12 +124,34 @@ static int thread_loop(void* thread_) {
         while (!thread->searching)
             cnd_wait(&thread->search_condition, &thread->search_mutex);
 
-        if (thread->quit)
+        if (thread->quit) {
+            mtx_unlock(&thread->search_mutex);
             break;
+        }
 
         mtx_unlock(&thread->search_mutex);
 
-        perform_search(&thread->searcher);
+        if (thread->task != nullptr) {
+            thread->task(thread->task_argument, thread->searcher.thread_index);
+            continue;
+        }
+
+        // The hardware counters only count the thread that opens them, so every thread profiles its own search.
+        struct PerfProfile* profiles = thread->searcher.thread_pool->profiles;
+        if (profiles == nullptr) {
+            perform_search(&thread->searcher);
+        } else {
+            struct PerfCounters counters;
+            start_perf_counters(&counters);
+            perform_search(&thread->searcher);
+            stop_perf_counters(&counters, &profiles[thread->searcher.thread_index]);
+
+            profiles[thread->searcher.thread_index].nodes += atomic_load(&thread->searcher.nodes_searched);
+        }
+
+#ifdef SEARCH_TRACE
+        flush_search_trace(&thread->searcher.trace);
+#endif /* #ifdef SEARCH_TRACE */
     }
 
     return thrd_success;
@@ -68,12 +161,23 @@ static int thread_loop(void* thread_) {
 static void construct_thread(struct Thread* thread) {
     assert(thread != nullptr);
 
-    thrd_create(&thread->handle, thread_loop, thread);
-
+    // The mutex and condition variable must be initialized before the thread starts using them. The thread signals that
+    // it has entered the idle loop by setting `searching` to `false`.
     mtx_init(&thread->search_mutex, mtx_plain);
     cnd_init(&thread->search_condition);
 
-    thread->quit = false;
+    thread->quit          = false;
+    thread->searching     = true;
+    thread->task          = nullptr;
+    thread->task_argument = nullptr;
+
+    clear_pawn_table(&thread->searcher.pawn_table);
+    clear_material_table(&thread->searcher.material_table);
+    clear_eval_cache(&thread->searcher.eval_cache);
+    thread->searcher.eval_cache.network_generation = 0;
+    thread->searcher.evaluator.network             = nullptr;
+
+    thrd_create(&thread->handle, thread_loop, thread);
 
     // Make sure the thread is in the idle loop before returning.
     wait_until_thread_finished_searching(thread);
@@ -121,8 +225,10 @@ void resize_thread_pool(struct ThreadPool* thread_pool, const size_t thread_coun
 
     wait_until_finished_searching(thread_pool, true);
 
-    while (thread_count < thread_pool->thread_count)
-        destroy_thread(&thread_pool->threads[thread_pool->thread_count--]);
+    // Every running thread holds a pointer to its own thread structure, so we can only reallocate the thread array once
+    // all threads have been destroyed.
+    while (thread_pool->thread_count > 0)
+        destroy_thread(&thread_pool->threads[--thread_pool->thread_count]);
 
     thread_pool->threads = realloc(thread_pool->threads, thread_count * sizeof(*thread_pool->threads));
 
@@ -142,6 +248,69 @@ void destroy_thread_pool(struct ThreadPool* thread_pool) {
     free(thread_pool->threads);
 }
 
+void run_task(struct ThreadPool* thread_pool, void (*task)(void* argument, size_t thread_index), void* argument) {
+    assert(thread_pool != nullptr);
+    assert(task != nullptr);
+
+    // A search that was started before the task stops itself once it has finished.
+    wait_until_finished_searching(thread_pool, true);
+    assert(atomic_load(&thread_pool->stop_search));
+
+    for (size_t i = 0; i < thread_pool->thread_count; ++i) {
+        struct Thread* thread = &thread_pool->threads[i];
+
+        thread->task                  = task;
+        thread->task_argument         = argument;
+        thread->searcher.thread_index = i;
+    }
+
+    for (size_t i = 0; i < thread_pool->thread_count; ++i)
+        start_search_thread(&thread_pool->threads[i]);
+
+    wait_until_finished_searching(thread_pool, true);
+
+    for (size_t i = 0; i < thread_pool->thread_count; ++i)
+        thread_pool->threads[i].task = nullptr;
+}
+
+
+// Initializes the `root_move_count` moves of `root_moves` such that they contain `moves` without any search results.
+static void init_root_moves(struct RootMove root_moves[static MAX_MOVES], const Move moves[static MAX_MOVES],
+                            const size_t root_move_count) {
+    assert(root_moves != nullptr);
+    assert(moves != nullptr);
+
+    for (size_t i = 0; i < root_move_count; ++i) {
+        struct RootMove* root_move = &root_moves[i];
+
+        root_move->move  = moves[i];
+        root_move->value = MIN_VALUE;
+        root_move->depth = 0;
+        root_move->nodes = 0;
+
+        // Until a root move has been searched, its principal variation consists of only the move itself.
+        root_move->principal_variation[0]      = root_move->move;
+        root_move->principal_variation_length = 1;
+    }
+}
+
+// Fills `root_move_queue` with the `root_move_count` moves of `root_moves`, which are ordered such that the most
+// promising root moves are handed out first.
+static void fill_root_move_queue(struct RootMoveQueue* root_move_queue, const Move root_moves[static MAX_MOVES],
+                                 const size_t root_move_count) {
+    assert(root_move_queue != nullptr);
+    assert(root_moves != nullptr);
+
+    init_root_moves(root_move_queue->root_moves, root_moves, root_move_count);
+    for (size_t i = 0; i < root_move_count; ++i)
+        atomic_flag_clear(&root_move_queue->root_move_locks[i]);
+
+    root_move_queue->root_move_count = root_move_count;
+    root_move_queue->reported_depth  = 0;
+    atomic_store(&root_move_queue->next_item, 0);
+    atomic_store(&root_move_queue->finished_searchers, 0);
+}
+
 
 void start_searching(struct ThreadPool* thread_pool, const struct Position* root_position) {
     assert(thread_pool != nullptr);
@@ -153,6 +322,7 @@ void start_searching(struct ThreadPool* thread_pool, const struct Position* root
 
     thread_pool->stop_search                 = false;
     thread_pool->search_aborted              = false;
+    thread_pool->stop_received               = false;
     struct SearchArguments* search_arguments = thread_pool->search_arguments;
 
     Move root_moves[MAX_MOVES];
@@ -165,26 +335,74 @@ void start_searching(struct ThreadPool* thread_pool, const struct Position* root
         root_move_count = generate_legal_moves(root_position, root_moves);
     }
 
+    // If the root position is in the tablebases, only the root moves with the best outcome are searched. When the DTZ
+    // tables rank them, the remaining moves also make progress under the 50 move rule, and probing during the search
+    // would only blur the distinction between them.
+    const size_t probe_limit = thread_pool->options->syzygy_probe_limit;
+    const size_t cardinality = tablebase_cardinality();
+    thread_pool->tablebase_probe_limit = (probe_limit < cardinality) ? probe_limit : cardinality;
+
+    uint64_t root_tablebase_hits = 0;
+    if (root_move_count > 0 && (size_t)popcount64(root_position->total_occupancy) <= thread_pool->tablebase_probe_limit
+        && root_position->info->castling_rights == CASTLE_NONE) {
+        struct Position position;
+        struct PositionInfo info;
+        memcpy(&position, root_position, sizeof(position));
+        memcpy(&info, root_position->info, sizeof(info));
+        position.info = &info;
+
+        const size_t ranked_count = root_move_count;
+        bool probe_in_search;
+        if (filter_root_moves(&position, root_moves, &root_move_count, &probe_in_search)) {
+            root_tablebase_hits = ranked_count;
+            if (!probe_in_search)
+                thread_pool->tablebase_probe_limit = 0;
+        }
+    }
+
+    // Sort the root moves once such that all searchers start with the most promising root moves.
     int8_t root_move_values[MAX_MOVES];
     compute_mvv_lva_values(root_position, root_moves, root_move_count, root_move_values);
+    for (size_t i = 0; i < root_move_count; ++i)
+        pick_root_move(root_moves, root_move_values, root_move_count, i);
 
-    if (!search_arguments->infinite_search)
+    if (thread_pool->options->split_root_moves)
+        fill_root_move_queue(&thread_pool->root_move_queue, root_moves, root_move_count);
+
+    // When pondering, the time manager is only updated on a ponderhit, which counts the time spent pondering as search
+    // time.
+    thread_pool->time_manager->start_time = get_time_us();
+    if (!search_arguments->infinite_search && !search_arguments->ponder)
         update_time_manager(thread_pool->time_manager, root_position->side_to_move);
+    atomic_store(&thread_pool->pondering, search_arguments->ponder);
+
+    atomic_store(&thread_pool->nodes_claimed, 0);
+    update_node_limit(thread_pool);
 
     struct Searcher* searcher;
     for (size_t i = 0; i < thread_pool->thread_count; ++i) {
         searcher = &thread_pool->threads[i].searcher;
 
         memcpy(&searcher->root_position, root_position, sizeof(*root_position));
-        memcpy(searcher->root_moves, root_moves, root_move_count * sizeof(*searcher->root_moves));
+        memcpy(&searcher->root_info, root_position->info, sizeof(*root_position->info));
+        searcher->root_position.info = &searcher->root_info;
+
+        // The network might have changed since the previous search, so we start with a fresh evaluator. Cached
+        // evaluations of another network are useless.
+        if (searcher->eval_cache.network_generation != current_network_generation()) {
+            clear_eval_cache(&searcher->eval_cache);
+            searcher->eval_cache.network_generation = current_network_generation();
+        }
+        searcher->eval_cache.probes = 0;
+        searcher->eval_cache.hits   = 0;
+
+        reset_evaluator(&searcher->evaluator, current_network());
+        refresh_accumulators(&searcher->evaluator, &searcher->root_position);
+        // The first root move is the best move until proven otherwise, such that we always have a move to return in
+        // case of short search times.
+        init_root_moves(searcher->root_moves, root_moves, root_move_count);
         searcher->root_move_count = root_move_count;
 
-        // Root moves have not been sorted yet.
-        searcher->sorted_until_index = 0;
-        memcpy(searcher->root_move_values, root_move_values, root_move_count * sizeof(*root_move_values));
-
-        // We set best_move to the first move such that we always have a move to return in case of short search times.
-        searcher->principal_variation_table[0][0] = root_moves[0];
         memset(searcher->principal_variation_length, 0,
                MAX_SEARCH_DEPTH * sizeof(*searcher->principal_variation_length));
 
@@ -195,10 +413,23 @@ void start_searching(struct ThreadPool* thread_pool, const struct Position* root
         // hence will never be preferred over the other thread.
         searcher->best_value     = MIN_VALUE;
         searcher->nodes_searched = 0;
+        searcher->tablebase_hits = (i == 0) ? root_tablebase_hits : 0;
+        searcher->node_budget    = 0;
+
+#ifdef SEARCH_STATISTICS
+        memset(&searcher->statistics, 0, sizeof(searcher->statistics));
+#endif /* #ifdef SEARCH_STATISTICS */
+
+#ifdef SEARCH_TRACE
+        reset_search_trace(&searcher->trace, i);
+#endif /* #ifdef SEARCH_TRACE */
 
         searcher->thread_pool  = thread_pool;
         searcher->thread_index = i;
+    }
 
+    // Only start the threads once all searchers have been set up, as the main thread reads the node counts of all
+    // searchers.
+    for (size_t i = 0; i < thread_pool->thread_count; ++i)
         start_search_thread(&thread_pool->threads[i]);
-    }
 }
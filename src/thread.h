@@ -8,8 +8,10 @@
 #include <stdint.h>
 #include <threads.h>
 
+#include "constants.h"
 #include "options.h"
 #include "position.h"
+#include "profiler.h"
 #include "search.h"
 #include "time_manager.h"
 #include "util.h"
@@ -26,9 +28,30 @@ struct Thread {
     bool searching;
     bool quit;
 
+    // When a task is set, the thread runs it instead of a search, see run_task().
+    void (*task)(void* argument, size_t thread_index);
+    void* task_argument;
+
     struct Searcher searcher;
 };
 
+// When root moves are split between threads, every combination of a depth and a root move is a work item. Work items are
+// handed out by incrementing `next_item`, which makes the queue lock-free. Item `i` corresponds to root move
+// `i % root_move_count` at depth `i / root_move_count + 1`, so all root moves of a depth are handed out before any root
+// move of the next depth. The result of each root move is stored in `root_moves`, guarded by a spin lock per root move,
+// as two threads might finish the same root move at different depths at the same time.
+struct RootMoveQueue {
+    struct RootMove root_moves[MAX_MOVES];
+    atomic_flag root_move_locks[MAX_MOVES];
+    size_t root_move_count;
+
+    _Atomic(size_t) next_item;
+    _Atomic(size_t) finished_searchers;
+
+    // The highest depth for which all root moves have been reported to UCI. Only used by the main thread.
+    size_t reported_depth;
+};
+
 // The engine structure contains a thread pool structure. This structure contains and controls all search threads and
 // acts as a bridge between the engine and the individual search threads. It also contains the time manager and search
 // arguments, as these are only affecting the behaviour of the search threads. The thread pool contains one "main"
@@ -40,9 +63,32 @@ struct ThreadPool {
 
     struct TimeManager* time_manager;
     struct SearchArguments* search_arguments;
+    const struct Options* options;
+
+    struct RootMoveQueue root_move_queue;
 
     _Atomic(bool) stop_search;
     _Atomic(bool) search_aborted;
+
+    // Whether the stop command has been received. Unlike `stop_search`, which the search also sets itself, e.g. when it
+    // has found a mate, this ends an infinite search or a ponder search.
+    _Atomic(bool) stop_received;
+
+    // While pondering, the search time is not limited. The cutoff time of the time manager is only valid once this is
+    // `false`.
+    _Atomic(bool) pondering;
+
+    // The nodes of a search are shared by all searchers. Searchers claim nodes in small batches, such that the total
+    // number of nodes searched never exceeds `node_limit`.
+    _Atomic(uint64_t) node_limit;
+    _Atomic(uint64_t) nodes_claimed;
+
+    // The largest number of pieces for which the searchers probe the tablebases, or 0 if they do not probe at all.
+    size_t tablebase_probe_limit;
+
+    // While profiling, the hardware counters and the nodes of the searches of every thread are added to the profile at
+    // its thread index. Otherwise, this is nullptr.
+    struct PerfProfile* profiles;
 };
 
 // Returns the main thread of `thread_pool`.
@@ -53,6 +99,33 @@ static INLINE const struct Thread* main_thread(const struct ThreadPool* thread_p
 }
 
 
+// Claims more nodes for `searcher` from its thread pool. If no nodes are left, the search is stopped and `false` is
+// returned.
+bool claim_nodes(struct Searcher* searcher);
+
+// Counts a node searched by `searcher`. Returns `false` if the node budget of the search is exhausted, in which case the
+// node must not be searched and the search has been stopped.
+static INLINE bool count_node(struct Searcher* searcher) {
+    assert(searcher != nullptr);
+
+    if (searcher->node_budget == 0 && !claim_nodes(searcher))
+        return false;
+
+    --searcher->node_budget;
+    atomic_fetch_add(&searcher->nodes_searched, 1);
+
+    return true;
+}
+
+// Updates the node limit of `thread_pool` from its search arguments and time manager. When a search is limited by
+// time, this must be called after the time manager has been updated.
+void update_node_limit(struct ThreadPool* thread_pool);
+
+// Returns the total number of nodes searched by all threads in `thread_pool`.
+size_t total_nodes_searched(const struct ThreadPool* thread_pool);
+// Returns the total number of tablebase hits of all threads in `thread_pool`.
+uint64_t total_tablebase_hits(const struct ThreadPool* thread_pool);
+
 // Waits until all threads in `thread_pool` are done searching and in an idle loop. If `wait_for_main_thread` is
 // `false`, we do not wait for the main thread.
 void wait_until_finished_searching(struct ThreadPool* thread_pool, const bool wait_for_main_thread);
@@ -62,6 +135,10 @@ void resize_thread_pool(struct ThreadPool* thread_pool, const size_t thread_coun
 // Destroys `thread_pool`.
 void destroy_thread_pool(struct ThreadPool* thread_pool);
 
+// Runs `task` on every thread of `thread_pool` and waits until all threads have finished it. Every thread calls
+// `task(argument, thread_index)`, and the threads divide the work among themselves through `argument`.
+void run_task(struct ThreadPool* thread_pool, void (*task)(void* argument, size_t thread_index), void* argument);
+
 // Start a search on `root_position`. `tread_pool` gives the threads the necessary information and starts them
 // individually.
 void start_searching(struct ThreadPool* thread_pool, const struct Position* position);
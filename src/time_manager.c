@@ -5,30 +5,107 @@
 #include <string.h>
 
 #include "piece.h"
+#include "score.h"
 
 
 
 void reset_time_manager(struct TimeManager* time_manager) {
     assert(time_manager != nullptr);
 
-    // Zero everything except for move overhead, as that is determined by the engine, not the search parameters.
+    // Zero everything except for move overhead and nodes time, as those are determined by the engine, not the search
+    // parameters.
     memset(time_manager, 0, offsetof(struct TimeManager, move_overhead));
 }
 
 void update_time_manager(struct TimeManager* time_manager, const enum Color side_to_move) {
     assert(time_manager != nullptr);
     assert(is_valid_color(side_to_move));
-    assert((time_manager->black_time > 0 && time_manager->white_time > 0) || time_manager->move_time > 0);
 
-    uint64_t search_time;
+    // In sudden death, we assume that the game lasts this many more moves.
+    constexpr size_t DEFAULT_MOVES_TO_GO = 20;
+
+    // The cutoff time is at most this many times the optimum time, and at most the following per mille of the time
+    // left, unless the time control ends after this move.
+    constexpr uint64_t MAX_OPTIMUM_TIME_FACTOR  = 4;
+    constexpr uint64_t MAX_TIME_LEFT_PER_MILLE = 300;
+    constexpr uint64_t LAST_MOVE_PER_MILLE     = 900;
+
+    time_manager->optimum_time = UINT64_MAX;
+    time_manager->cutoff_time  = UINT64_MAX;
+    time_manager->cutoff_nodes = UINT64_MAX;
+
+    // A search can also be limited by something other than time, like depth or mate, in which case it never runs out of
+    // time. Only the clock of the side to move matters.
+    const uint64_t time_left = (side_to_move == COLOR_WHITE) ? time_manager->white_time : time_manager->black_time;
+    if (time_left == 0 && time_manager->move_time == 0)
+        return;
+
+    // When searching a number of nodes per millisecond, the search time is not measured, so there is no overhead either.
+    const uint64_t move_overhead = (time_manager->nodes_time != 0) ? 0 : time_manager->move_overhead;
+
+    uint64_t optimum_time;
+    uint64_t cutoff_time;
     if (time_manager->move_time != 0) {
-        search_time = time_manager->move_time;
+        // There is no reason to stop early with a fixed move time, as the remaining time can not be used later.
+        cutoff_time  = (move_overhead > time_manager->move_time) ? 0 : time_manager->move_time - move_overhead;
+        optimum_time = UINT64_MAX;
     } else {
-        const uint64_t white_search_time = time_manager->white_time / 20 + time_manager->white_increment / 2;
-        const uint64_t black_search_time = time_manager->black_time / 20 + time_manager->black_increment / 2;
-        search_time                      = (side_to_move == COLOR_WHITE) ? white_search_time : black_search_time;
+        const uint64_t increment = (side_to_move == COLOR_WHITE) ? time_manager->white_increment
+                                                                 : time_manager->black_increment;
+        const size_t moves_to_go = (time_manager->moves_to_go == 0) ? DEFAULT_MOVES_TO_GO : time_manager->moves_to_go;
+
+        const uint64_t available_time = (move_overhead > time_left) ? 0 : time_left - move_overhead;
+
+        optimum_time = available_time / moves_to_go + increment / 2;
+        cutoff_time  = MAX_OPTIMUM_TIME_FACTOR * optimum_time;
+
+        // We must never flag, so the time we may spend on a single move is limited by the time left on the clock.
+        const uint64_t max_time = available_time / 1000
+                                * ((moves_to_go == 1) ? LAST_MOVE_PER_MILLE : MAX_TIME_LEFT_PER_MILLE);
+        if (cutoff_time > max_time)
+            cutoff_time = max_time;
+        if (optimum_time > cutoff_time)
+            optimum_time = cutoff_time;
+    }
+
+    if (time_manager->nodes_time != 0) {
+        // The optimum time does not apply to node counts, so we search all nodes of the optimum time.
+        const uint64_t search_time = (optimum_time == UINT64_MAX) ? cutoff_time : optimum_time;
+        time_manager->cutoff_nodes = search_time / 1000 * time_manager->nodes_time;
+        return;
     }
 
-    search_time = (time_manager->move_overhead > search_time) ? 0 : search_time - time_manager->move_overhead;
-    time_manager->cutoff_time = get_time_us() + search_time;
+    time_manager->optimum_time = optimum_time;
+    time_manager->cutoff_time  = time_manager->start_time + cutoff_time;
+}
+
+bool optimum_time_exceeded(const struct TimeManager* time_manager, const size_t best_move_stability,
+                           const uint64_t best_move_node_share, const Value value_drop) {
+    assert(time_manager != nullptr);
+    assert(best_move_node_share <= 1000);
+
+    if (time_manager->optimum_time == UINT64_MAX)
+        return false;
+
+    // All factors are in percent. A stable best move that takes up most of the search effort indicates an easy
+    // position, while a dropping value indicates that the best move was refuted and more time is needed to find a
+    // replacement.
+    constexpr size_t MAX_STABILITY = 6;
+    constexpr Value MAX_VALUE_DROP = 100;
+
+    const size_t stability          = (best_move_stability > MAX_STABILITY) ? MAX_STABILITY : best_move_stability;
+    const uint64_t stability_factor = 140 - 10 * stability;
+    const uint64_t node_factor      = 150 - best_move_node_share / 10;
+
+    Value clamped_value_drop = (value_drop < 0) ? 0 : value_drop;
+    if (clamped_value_drop > MAX_VALUE_DROP)
+        clamped_value_drop = MAX_VALUE_DROP;
+    const uint64_t value_factor = 100 + (uint64_t)clamped_value_drop / 2;
+
+    const uint64_t optimum_time = time_manager->optimum_time * stability_factor / 100 * node_factor / 100 * value_factor
+                                / 100;
+
+    // The next iteration usually takes longer than all previous iterations together, so if we have used more than half
+    // of the optimum time, the next iteration would most likely exceed it.
+    return 2 * (get_time_us() - time_manager->start_time) >= optimum_time;
 }
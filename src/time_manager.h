@@ -6,6 +6,7 @@
 #include <stdint.h>
 
 #include "piece.h"
+#include "score.h"
 #include "util.h"
 
 
@@ -49,19 +50,36 @@ struct TimeManager {
     uint64_t move_time;
     size_t moves_to_go;
 
+    // The optimum time is the search time we aim for, which is adjusted during the search depending on how difficult
+    // the position turns out to be. The cutoff time is a hard limit that is never exceeded.
+    uint64_t start_time;
+    uint64_t optimum_time;
     uint64_t cutoff_time;
+    uint64_t cutoff_nodes;
 
     uint64_t move_overhead;
+
+    // If nonzero, the number of nodes that is searched per millisecond of search time. The search is then limited by
+    // `cutoff_nodes` instead of `cutoff_time`, which makes it independent of the load of the machine.
+    uint64_t nodes_time;
 };
 
 
-// Sets all elements of `time_manager` except for `move_overhead` to 0.
+// Sets all elements of `time_manager` except for `move_overhead` and `nodes_time` to 0.
 void reset_time_manager(struct TimeManager* time_manager);
 
-// Computes and updates the `cutoff_time` element in `time_manager` for `side_to_move`. This value is used to determine
-// when to stop searching the current position.
+// Computes and updates the `optimum_time`, `cutoff_time` and `cutoff_nodes` elements in `time_manager` for
+// `side_to_move`, counting from the `start_time` element. These values are used to determine when to stop searching the
+// current position. If no time is given, the limits are never reached.
 void update_time_manager(struct TimeManager* time_manager, enum Color side_to_move);
 
+// Returns whether the optimum time of `time_manager` is exceeded after an iteration of the search, such that a new
+// iteration should not be started. The optimum time is shortened if the best move has stayed the same for
+// `best_move_stability` iterations and its subtree holds `best_move_node_share` per mille of the nodes searched, and
+// it is extended if the value of the best move dropped `value_drop` compared to the previous iteration.
+bool optimum_time_exceeded(const struct TimeManager* time_manager, size_t best_move_stability,
+                           uint64_t best_move_node_share, Value value_drop);
+
 
 
 #endif /* #ifndef WINDMOLEN_TIME_MANAGER_H_ */
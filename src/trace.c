@@ -0,0 +1,81 @@
+#include "trace.h"
+
+#include <assert.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <threads.h>
+
+
+
+// The trace file is shared by all searchers, which append their chunks to it under the mutex.
+static FILE* trace_file = nullptr;
+static mtx_t trace_mutex;
+static once_flag trace_once = ONCE_FLAG_INIT;
+
+// The number of searches traced to the current trace file.
+static uint32_t trace_searches = 0;
+
+
+static void initialize_trace_mutex() {
+    mtx_init(&trace_mutex, mtx_plain);
+}
+
+bool open_search_trace(const char* path) {
+    assert(path != nullptr);
+
+    close_search_trace();
+
+    FILE* file = fopen(path, "wb");
+    if (file == nullptr)
+        return false;
+
+    const uint32_t header[2] = {TRACE_VERSION, sizeof(struct TraceEvent)};
+    if (fwrite(TRACE_MAGIC, sizeof(TRACE_MAGIC), 1, file) != 1 || fwrite(header, sizeof(header), 1, file) != 1) {
+        fclose(file);
+        return false;
+    }
+
+    call_once(&trace_once, initialize_trace_mutex);
+    trace_file     = file;
+    trace_searches = 0;
+
+    return true;
+}
+
+void close_search_trace() {
+    if (trace_file == nullptr)
+        return;
+
+    fclose(trace_file);
+    trace_file = nullptr;
+}
+
+void reset_search_trace(struct SearchTrace* trace, const size_t thread_index) {
+    assert(trace != nullptr);
+
+    // The main searcher is prepared first, so it starts the numbering of a new search.
+    if (thread_index == 0 && trace_file != nullptr)
+        ++trace_searches;
+
+    trace->enabled      = trace_file != nullptr;
+    trace->search       = trace_searches;
+    trace->thread_index = (uint32_t)thread_index;
+    trace->event_count  = 0;
+}
+
+void flush_search_trace(struct SearchTrace* trace) {
+    assert(trace != nullptr);
+
+    if (!trace->enabled || trace->event_count == 0)
+        return;
+
+    const uint32_t header[3] = {trace->search, trace->thread_index, (uint32_t)trace->event_count};
+
+    mtx_lock(&trace_mutex);
+    fwrite(header, sizeof(header), 1, trace_file);
+    fwrite(trace->events, sizeof(*trace->events), trace->event_count, trace_file);
+    mtx_unlock(&trace_mutex);
+
+    trace->event_count = 0;
+}
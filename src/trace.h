@@ -0,0 +1,122 @@
+#ifndef WINDMOLEN_TRACE_H_
+#define WINDMOLEN_TRACE_H_
+
+
+#include <assert.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "move.h"
+#include "score.h"
+#include "util.h"
+
+
+
+// A search trace file starts with TRACE_MAGIC, followed by the version and the size of an event as 32 bit integers.
+// The rest of the file consists of chunks. A chunk is a header of three 32 bit integers, the search number, the thread
+// index and the number of events, followed by that many events. All integers are stored in native byte order.
+static constexpr char TRACE_MAGIC[8]    = "WMTRACE";
+static constexpr uint32_t TRACE_VERSION = 1;
+
+// The number of events a searcher buffers before it appends them to the trace file.
+static constexpr size_t TRACE_BUFFER_SIZE = 1 << 14;
+
+// The number of plies for which a searcher tracks the cutoff index. The quiescence search never gets this deep.
+static constexpr size_t TRACE_MAX_PLY = 256;
+
+// The cutoff index of a node that did not fail high on one of its moves.
+static constexpr uint8_t TRACE_NO_CUTOFF = UINT8_MAX;
+
+// A single searched node, recorded by its parent once the node has been searched. The window and the value are seen
+// from the side to move in the node. The depth is 0 for nodes of the quiescence search. The move index is the position
+// of `move` in the move ordering of the parent.
+struct TraceEvent {
+    Move move;
+    Score alpha;
+    Score beta;
+    Score value;
+    uint8_t ply;
+    uint8_t depth;
+    uint8_t cutoff_index;
+    uint8_t move_index;
+};
+
+static_assert(sizeof(struct TraceEvent) == 12, "trace events are written to the trace file as is");
+
+// The trace buffer of a single searcher. It is only touched by its own searcher, so recording needs no locking, and it
+// is appended to the trace file when it is full and when the search has finished.
+struct SearchTrace {
+    bool enabled;
+    uint32_t search;
+    uint32_t thread_index;
+
+    // The index of the move that caused a beta cutoff in the node at every ply, or TRACE_NO_CUTOFF.
+    uint8_t cutoff_indices[TRACE_MAX_PLY];
+
+    struct TraceEvent events[TRACE_BUFFER_SIZE];
+    size_t event_count;
+};
+
+
+// Creates the trace file at `path` and makes all following searches append their traces to it. A previously opened
+// trace file is closed first. Returns whether the file could be created.
+bool open_search_trace(const char* path);
+
+// Closes the trace file, if any. No searches may be running.
+void close_search_trace();
+
+// Prepares `trace` for a new search by the searcher with `thread_index`. Tracing is only enabled if a trace file is
+// open. All searchers of a single search must be prepared before the next search is started.
+void reset_search_trace(struct SearchTrace* trace, size_t thread_index);
+
+// Appends the buffered events of `trace` to the trace file as one chunk and empties the buffer.
+void flush_search_trace(struct SearchTrace* trace);
+
+// Marks the node at `ply` as not having failed high yet. Must be called on entry of every node.
+static INLINE void enter_trace_node(struct SearchTrace* trace, const size_t ply) {
+    assert(trace != nullptr);
+    assert(ply < TRACE_MAX_PLY);
+
+    trace->cutoff_indices[ply] = TRACE_NO_CUTOFF;
+}
+
+// Records that the move at `index` of the node at `ply` caused a beta cutoff.
+static INLINE void trace_cutoff(struct SearchTrace* trace, const size_t ply, const size_t index) {
+    assert(trace != nullptr);
+    assert(ply < TRACE_MAX_PLY);
+    assert(index < TRACE_NO_CUTOFF);
+
+    trace->cutoff_indices[ply] = (uint8_t)index;
+}
+
+// Records the node at `ply` that was reached by `move`, the move at `move_index` of its parent, searched to `depth`
+// with the window from `alpha` to `beta`, and returned `value`. The cutoff index is taken from the node itself, so this
+// must be called right after it returned.
+static INLINE void trace_node(struct SearchTrace* trace, const Move move, const size_t move_index, const size_t ply,
+                              const size_t depth, const Value alpha, const Value beta, const Value value) {
+    assert(trace != nullptr);
+    assert(ply < TRACE_MAX_PLY);
+    assert(move_index <= UINT8_MAX);
+    assert(depth <= UINT8_MAX);
+
+    if (!trace->enabled)
+        return;
+
+    trace->events[trace->event_count++] = (struct TraceEvent){
+        .move         = move,
+        .alpha        = (Score)alpha,
+        .beta         = (Score)beta,
+        .value        = (Score)value,
+        .ply          = (uint8_t)ply,
+        .depth        = (uint8_t)depth,
+        .cutoff_index = trace->cutoff_indices[ply],
+        .move_index   = (uint8_t)move_index,
+    };
+
+    if (trace->event_count == TRACE_BUFFER_SIZE)
+        flush_search_trace(trace);
+}
+
+
+
+#endif /* #ifndef WINDMOLEN_TRACE_H_ */
@@ -6,17 +6,25 @@
 #include <stddef.h>
 #include <stdint.h>
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
 
+#include "bench.h"
 #include "board.h"
 #include "engine.h"
 #include "move.h"
+#include "nnue.h"
+#include "nnue_kernels.h"
 #include "options.h"
 #include "perft.h"
 #include "piece.h"
 #include "position.h"
+#include "profiler.h"
 #include "score.h"
+#include "syzygy.h"
+#include "thread.h"
 #include "time_manager.h"
+#include "trace.h"
 
 
 
@@ -51,8 +59,9 @@ static Move parse_move(const struct Position* position, const char* move_string)
     return new_move(source, destination, move_type);
 }
 
-void print_move(const Move move) {
+void move_to_string(const Move move, char string[static MOVE_STRING_SIZE]) {
     assert(!is_weird_move(move));
+    assert(string != nullptr);
 
     // clang-format off
     static const char square_to_string[SQUARE_COUNT][3] = {
@@ -67,10 +76,18 @@ void print_move(const Move move) {
     };
     // clang-format on
 
-    printf("%s%s", square_to_string[move_source(move)], square_to_string[move_destination(move)]);
+    memcpy(string, square_to_string[move_source(move)], 2);
+    memcpy(string + 2, square_to_string[move_destination(move)], 2);
+    string[4] = (type_of_move(move) == MOVE_TYPE_PROMOTION) ? promotion_to_char(move) : '\0';
+    string[5] = '\0';
+}
 
-    if (type_of_move(move) == MOVE_TYPE_PROMOTION)
-        putchar(promotion_to_char(move));
+void print_move(const Move move) {
+    assert(!is_weird_move(move));
+
+    char string[MOVE_STRING_SIZE];
+    move_to_string(move, string);
+    fputs(string, stdout);
 }
 
 
@@ -103,16 +120,200 @@ static void uci_options() {
     printf("option name %s type %s default %" PRIu64 " min %" PRIu64 " max %" PRIu64 "\n", OPTION_MOVE_OVERHEAD_NAME,
            type_to_string[OPTION_MOVE_OVERHEAD_TYPE], OPTION_MOVE_OVERHEAD_DEFAULT, OPTION_MOVE_OVERHEAD_MIN,
            OPTION_MOVE_OVERHEAD_MAX);
+    printf("option name %s type %s default %" PRIu64 " min %" PRIu64 " max %" PRIu64 "\n", OPTION_NODES_TIME_NAME,
+           type_to_string[OPTION_NODES_TIME_TYPE], OPTION_NODES_TIME_DEFAULT, OPTION_NODES_TIME_MIN,
+           OPTION_NODES_TIME_MAX);
+    printf("option name %s type %s default %zu min %zu max %zu\n", OPTION_MULTI_PV_NAME,
+           type_to_string[OPTION_MULTI_PV_TYPE], OPTION_MULTI_PV_DEFAULT, OPTION_MULTI_PV_MIN, OPTION_MULTI_PV_MAX);
+    printf("option name %s type %s default %s\n", OPTION_SPLIT_ROOT_MOVES_NAME,
+           type_to_string[OPTION_SPLIT_ROOT_MOVES_TYPE], OPTION_SPLIT_ROOT_MOVES_DEFAULT ? "true" : "false");
+    printf("option name %s type %s default %s\n", OPTION_EVAL_FILE_NAME, type_to_string[OPTION_EVAL_FILE_TYPE],
+           OPTION_EVAL_FILE_DEFAULT);
+    printf("option name %s type %s default %s\n", OPTION_SYZYGY_PATH_NAME, type_to_string[OPTION_SYZYGY_PATH_TYPE],
+           OPTION_SYZYGY_PATH_DEFAULT);
+    printf("option name %s type %s default %zu min %zu max %zu\n", OPTION_SYZYGY_PROBE_DEPTH_NAME,
+           type_to_string[OPTION_SYZYGY_PROBE_DEPTH_TYPE], OPTION_SYZYGY_PROBE_DEPTH_DEFAULT,
+           OPTION_SYZYGY_PROBE_DEPTH_MIN, OPTION_SYZYGY_PROBE_DEPTH_MAX);
+    printf("option name %s type %s default %zu min %zu max %zu\n", OPTION_SYZYGY_PROBE_LIMIT_NAME,
+           type_to_string[OPTION_SYZYGY_PROBE_LIMIT_TYPE], OPTION_SYZYGY_PROBE_LIMIT_DEFAULT,
+           OPTION_SYZYGY_PROBE_LIMIT_MIN, OPTION_SYZYGY_PROBE_LIMIT_MAX);
+    printf("option name %s type %s default %zu min %zu max %zu\n", OPTION_PERFT_SPLIT_DEPTH_NAME,
+           type_to_string[OPTION_PERFT_SPLIT_DEPTH_TYPE], OPTION_PERFT_SPLIT_DEPTH_DEFAULT,
+           OPTION_PERFT_SPLIT_DEPTH_MIN, OPTION_PERFT_SPLIT_DEPTH_MAX);
+    printf("option name %s type %s default %" PRIu64 " min %" PRIu64 " max %" PRIu64 "\n", OPTION_PERFT_HASH_SIZE_NAME,
+           type_to_string[OPTION_PERFT_HASH_SIZE_TYPE], OPTION_PERFT_HASH_SIZE_DEFAULT, OPTION_PERFT_HASH_SIZE_MIN,
+           OPTION_PERFT_HASH_SIZE_MAX);
 }
 
-void uci_best_move(const Move best_move) {
-    assert(!is_weird_move(best_move));
+void uci_best_move(const Move best_move, const Move ponder_move) {
+    assert(best_move == NULL_MOVE || !is_weird_move(best_move));
+
+    if (best_move == NULL_MOVE) {
+        puts("bestmove 0000");
+        return;
+    }
 
     printf("bestmove ");
     print_move(best_move);
+
+    if (ponder_move != NULL_MOVE) {
+        printf(" ponder ");
+        print_move(ponder_move);
+    }
+
     putchar('\n');
 }
 
+void uci_eval_cache_info(const uint64_t probes, const uint64_t hits) {
+    assert(probes > 0);
+    assert(hits <= probes);
+
+    printf("info string eval cache hits %" PRIu64 " of %" PRIu64 " probes (%" PRIu64 "%%)\n", hits, probes,
+           100 * hits / probes);
+}
+
+void uci_no_mate_info(const size_t moves, const size_t nodes, const uint64_t time) {
+    printf("info nodes %zu time %" PRIu64 " string no mate in %zu moves\n", nodes, time / 1000, moves);
+}
+
+void uci_search_statistics_info(const uint64_t nodes, const uint64_t quiescence_nodes, const uint64_t cutoffs,
+                                const uint64_t first_move_cutoffs, const uint64_t cutoff_index_sum,
+                                const uint64_t material_draw_cutoffs, const double branching_factor) {
+    // The counters of other threads may be read while they are searching, so they are not exactly consistent.
+    const double quiescence_share = (nodes == 0) ? 0.0 : 100.0 * (double)quiescence_nodes / (double)nodes;
+
+    printf("info string qnodes %.1f%% cutoffs %" PRIu64, quiescence_share, cutoffs);
+    if (cutoffs > 0)
+        printf(" firstmove %.1f%% cutoffindex %.2f", 100.0 * (double)first_move_cutoffs / (double)cutoffs,
+               (double)cutoff_index_sum / (double)cutoffs);
+    printf(" materialdraws %" PRIu64, material_draw_cutoffs);
+    if (branching_factor > 0.0)
+        printf(" ebf %.2f", branching_factor);
+    putchar('\n');
+}
+
+
+// Runs the bench command, whose optional arguments are the depth, the number of threads and the hash size, which is a
+// no-op for now, see bench(). Arguments out of range are clamped.
+static void handle_bench(struct Engine* engine) {
+    assert(engine != nullptr);
+
+    size_t depth        = BENCH_DEFAULT_DEPTH;
+    size_t thread_count = OPTION_THREAD_COUNT_DEFAULT;
+    uint64_t hash_size  = OPTION_HASH_SIZE_DEFAULT;
+
+    // strtok() has already been 'initialized' in the main UCI loop.
+    const char* argument = strtok(nullptr, DELIMETERS);
+    if (argument != nullptr) {
+        depth    = (size_t)strtoull(argument, nullptr, 10);
+        argument = strtok(nullptr, DELIMETERS);
+    }
+    if (argument != nullptr) {
+        thread_count = (size_t)strtoull(argument, nullptr, 10);
+        argument     = strtok(nullptr, DELIMETERS);
+    }
+    if (argument != nullptr)
+        hash_size = (uint64_t)strtoull(argument, nullptr, 10);
+
+    depth        = (depth < 1) ? 1 : (depth > MAX_SEARCH_DEPTH) ? MAX_SEARCH_DEPTH : depth;
+    thread_count = (thread_count < OPTION_THREAD_COUNT_MIN)   ? OPTION_THREAD_COUNT_MIN
+                 : (thread_count > OPTION_THREAD_COUNT_MAX) ? OPTION_THREAD_COUNT_MAX
+                                                            : thread_count;
+    hash_size    = (hash_size < OPTION_HASH_SIZE_MIN)   ? OPTION_HASH_SIZE_MIN
+                 : (hash_size > OPTION_HASH_SIZE_MAX) ? OPTION_HASH_SIZE_MAX
+                                                      : hash_size;
+
+    bench(engine, depth, thread_count, hash_size);
+}
+
+// Runs the perftsuite command, whose arguments are the path of an EPD file, and optionally the maximum depth and the
+// number of threads. Arguments out of range are clamped.
+static void handle_perft_suite(struct Engine* engine) {
+    assert(engine != nullptr);
+
+    // strtok() has already been 'initialized' in the main UCI loop.
+    const char* path = strtok(nullptr, DELIMETERS);
+    if (path == nullptr)
+        return;
+
+    size_t max_depth    = MAX_SEARCH_DEPTH;
+    size_t thread_count = engine->options.thread_count;
+
+    const char* argument = strtok(nullptr, DELIMETERS);
+    if (argument != nullptr) {
+        max_depth = (size_t)strtoull(argument, nullptr, 10);
+        argument  = strtok(nullptr, DELIMETERS);
+    }
+    if (argument != nullptr)
+        thread_count = (size_t)strtoull(argument, nullptr, 10);
+
+    max_depth    = (max_depth < 1) ? 1 : max_depth;
+    thread_count = (thread_count < OPTION_THREAD_COUNT_MIN)   ? OPTION_THREAD_COUNT_MIN
+                 : (thread_count > OPTION_THREAD_COUNT_MAX) ? OPTION_THREAD_COUNT_MAX
+                                                            : thread_count;
+
+    wait_until_finished_searching(&engine->thread_pool, true);
+
+    if (!perft_suite(&engine->thread_pool, path, max_depth, thread_count))
+        printf("info string could not read perft suite %s\n", path);
+}
+
+// Loads the network in `path`, which is the remainder of the setoption command and may contain spaces. The network is
+// swapped between searches, the threads pick it up when they start their next search.
+static void handle_eval_file(struct Engine* engine, char* path) {
+    assert(engine != nullptr);
+
+    if (path == nullptr)
+        return;
+
+    // Strip the trailing white space.
+    size_t length = strlen(path);
+    while (length > 0 && isspace((unsigned char)path[length - 1]))
+        path[--length] = '\0';
+
+    if (length == 0 || length >= OPTION_EVAL_FILE_MAX_LENGTH)
+        return;
+
+    wait_until_finished_searching(&engine->thread_pool, true);
+
+    if (strcmp(path, OPTION_EVAL_FILE_DEFAULT) == 0) {
+        use_default_network();
+    } else if (!load_network(path)) {
+        printf("info string could not load network %s, keeping %s\n", path, engine->options.eval_file);
+        return;
+    }
+
+    strcpy(engine->options.eval_file, path);
+    printf("info string using network %s\n", path);
+}
+
+// Looks for tablebases in `paths`, which is the remainder of the setoption command and may contain spaces. The tables
+// are shared by all threads, so they are only replaced between searches.
+static void handle_syzygy_path(struct Engine* engine, char* paths) {
+    assert(engine != nullptr);
+
+    if (paths == nullptr)
+        return;
+
+    // Strip the trailing white space.
+    size_t length = strlen(paths);
+    while (length > 0 && isspace((unsigned char)paths[length - 1]))
+        paths[--length] = '\0';
+
+    if (length == 0 || length >= OPTION_SYZYGY_PATH_MAX_LENGTH)
+        return;
+
+    wait_until_finished_searching(&engine->thread_pool, true);
+
+    strcpy(engine->options.syzygy_path, paths);
+    if (strcmp(paths, OPTION_SYZYGY_PATH_DEFAULT) == 0) {
+        free_tablebases();
+        return;
+    }
+
+    const size_t table_count = initialize_tablebases(paths);
+    printf("info string found %zu tablebases with up to %zu pieces\n", table_count, tablebase_cardinality());
+}
 
 static void handle_setoption(struct Engine* engine) {
     assert(engine != nullptr);
@@ -138,14 +339,44 @@ static void handle_setoption(struct Engine* engine) {
         // TODO: Clear hash when hash is implemented.
     } else if (strcmp(option_name, OPTION_PONDER_MODE_NAME) == 0) {
         const char* ponder_mode = strtok(nullptr, DELIMETERS);
-        if (strcmp(ponder_mode, "false")) {
+        if (strcmp(ponder_mode, "false") == 0) {
             engine->options.ponder_mode = false;
-        } else if (strcmp(ponder_mode, "true")) {
+        } else if (strcmp(ponder_mode, "true") == 0) {
             engine->options.ponder_mode = true;
         }
     } else if (strcmp(option_name, OPTION_MOVE_OVERHEAD_NAME) == 0) {
-        engine->options.move_overhead      = 1000ULL * (uint64_t)strtoull(strtok(nullptr, DELIMETERS), nullptr, 10);
-        engine->time_manager.move_overhead = engine->options.move_overhead;
+        engine->options.move_overhead      = (uint64_t)strtoull(strtok(nullptr, DELIMETERS), nullptr, 10);
+        engine->time_manager.move_overhead = 1000ULL * engine->options.move_overhead;
+    } else if (strcmp(option_name, OPTION_NODES_TIME_NAME) == 0) {
+        engine->options.nodes_time      = (uint64_t)strtoull(strtok(nullptr, DELIMETERS), nullptr, 10);
+        engine->time_manager.nodes_time = engine->options.nodes_time;
+    } else if (strcmp(option_name, OPTION_MULTI_PV_NAME) == 0) {
+        const size_t multi_pv    = (size_t)strtoull(strtok(nullptr, DELIMETERS), nullptr, 10);
+        engine->options.multi_pv = (multi_pv < OPTION_MULTI_PV_MIN)   ? OPTION_MULTI_PV_MIN
+                                 : (multi_pv > OPTION_MULTI_PV_MAX) ? OPTION_MULTI_PV_MAX
+                                                                    : multi_pv;
+    } else if (strcmp(option_name, OPTION_SPLIT_ROOT_MOVES_NAME) == 0) {
+        engine->options.split_root_moves = strcmp(strtok(nullptr, DELIMETERS), "true") == 0;
+    } else if (strcmp(option_name, OPTION_EVAL_FILE_NAME) == 0) {
+        handle_eval_file(engine, strtok(nullptr, ""));
+    } else if (strcmp(option_name, OPTION_SYZYGY_PATH_NAME) == 0) {
+        handle_syzygy_path(engine, strtok(nullptr, ""));
+    } else if (strcmp(option_name, OPTION_SYZYGY_PROBE_DEPTH_NAME) == 0) {
+        const size_t probe_depth = (size_t)strtoull(strtok(nullptr, DELIMETERS), nullptr, 10);
+        engine->options.syzygy_probe_depth =
+            (probe_depth < OPTION_SYZYGY_PROBE_DEPTH_MIN)   ? OPTION_SYZYGY_PROBE_DEPTH_MIN
+            : (probe_depth > OPTION_SYZYGY_PROBE_DEPTH_MAX) ? OPTION_SYZYGY_PROBE_DEPTH_MAX
+                                                            : probe_depth;
+    } else if (strcmp(option_name, OPTION_SYZYGY_PROBE_LIMIT_NAME) == 0) {
+        const size_t probe_limit = (size_t)strtoull(strtok(nullptr, DELIMETERS), nullptr, 10);
+        engine->options.syzygy_probe_limit =
+            (probe_limit > OPTION_SYZYGY_PROBE_LIMIT_MAX) ? OPTION_SYZYGY_PROBE_LIMIT_MAX : probe_limit;
+    } else if (strcmp(option_name, OPTION_PERFT_SPLIT_DEPTH_NAME) == 0) {
+        engine->options.perft_split_depth = (size_t)strtoull(strtok(nullptr, DELIMETERS), nullptr, 10);
+    } else if (strcmp(option_name, OPTION_PERFT_HASH_SIZE_NAME) == 0) {
+        const uint64_t hash_size = (uint64_t)strtoull(strtok(nullptr, DELIMETERS), nullptr, 10);
+        engine->options.perft_hash_size =
+            (hash_size > OPTION_PERFT_HASH_SIZE_MAX) ? OPTION_PERFT_HASH_SIZE_MAX : hash_size;
     }
 }
 
@@ -193,6 +424,9 @@ static void handle_go(struct Engine* engine) {
     struct SearchArguments* search_arguments = &engine->search_arguments;
     struct TimeManager* time_manager         = &engine->time_manager;
 
+    // The arguments of a search that is still running must not change under it.
+    wait_until_finished_searching(&engine->thread_pool, true);
+
     reset_time_manager(time_manager);
     reset_search_arguments(search_arguments);
 
@@ -220,8 +454,6 @@ static void handle_go(struct Engine* engine) {
             search_arguments->infinite_search = false;
             time_manager->moves_to_go         = (size_t)strtoull(strtok(nullptr, DELIMETERS), nullptr, 10);
         } else if (strcmp(argument, "nodes") == 0) {
-            // Not fully correctly implemented. The search will stop if the maximum amount of nodes is reached, but this
-            // amount may be exceeded by quite a bit.
             search_arguments->infinite_search  = false;
             search_arguments->max_search_nodes = (size_t)strtoull(strtok(nullptr, DELIMETERS), nullptr, 10);
         } else if (strcmp(argument, "depth") == 0) {
@@ -237,20 +469,19 @@ static void handle_go(struct Engine* engine) {
                 argument                                                              = strtok(nullptr, DELIMETERS);
             }
         } else if (strcmp(argument, "mate") == 0) {
-            // TODO: Not implemented yet.
             search_arguments->infinite_search = false;
             search_arguments->mate_in_x       = (size_t)strtoull(strtok(nullptr, DELIMETERS), nullptr, 10);
         } else {
             if (strcmp(argument, "perft") == 0) {
                 // Regular perft.
-                const size_t nodes = perft(&engine->position,
-                                           (size_t)strtoull(strtok(nullptr, DELIMETERS), nullptr, 10));
+                const size_t depth = (size_t)strtoull(strtok(nullptr, DELIMETERS), nullptr, 10);
+                const size_t nodes = perft(&engine->thread_pool, &engine->position, depth);
                 printf("Nodes searched: %zu\n", nodes);
             } else if (strcmp(argument, "extperft") == 0) {
                 // Extended perth.
                 struct ExtendedPerft ext_perft;
                 const size_t depth = (size_t)strtoull(strtok(nullptr, DELIMETERS), nullptr, 10);
-                const size_t nodes = extended_perft(&engine->position, depth, &ext_perft);
+                const size_t nodes = extended_perft(&engine->thread_pool, &engine->position, depth, &ext_perft);
                 printf("Nodes searched:            %zu\n\n", nodes);
                 printf("Captures:                  %zu\n", ext_perft.captures);
                 printf("En passants:               %zu\n", ext_perft.en_passants);
@@ -271,9 +502,22 @@ static void handle_go(struct Engine* engine) {
                                                            + ext_perft.direct_discovered_mates
                                                            + ext_perft.double_discovered_mates);
             } else if (strcmp(argument, "divide") == 0) {
-                const size_t nodes_searched = divide(&engine->position,
-                                                     (size_t)strtoull(strtok(nullptr, DELIMETERS), nullptr, 10));
+                const size_t depth          = (size_t)strtoull(strtok(nullptr, DELIMETERS), nullptr, 10);
+                const size_t nodes_searched = divide(&engine->thread_pool, &engine->position, depth);
                 printf("\nNodes searched: %zu\n", nodes_searched);
+            } else if (strcmp(argument, "perftjob") == 0) {
+                const size_t depth = (size_t)strtoull(strtok(nullptr, DELIMETERS), nullptr, 10);
+                const char* path   = strtok(nullptr, DELIMETERS);
+
+                const char* processes = strtok(nullptr, DELIMETERS);
+                size_t process_count  = (processes != nullptr) ? (size_t)strtoull(processes, nullptr, 10) : 1;
+                process_count         = (process_count < 1)                         ? 1
+                                      : (process_count > PERFT_JOB_MAX_PROCESSES) ? PERFT_JOB_MAX_PROCESSES
+                                                                                  : process_count;
+
+                if (depth > 0 && path != nullptr
+                    && !perft_job(&engine->thread_pool, &engine->position, depth, path, process_count))
+                    printf("info string could not use checkpoint %s\n", path);
             } else if (strcmp(argument, "print") == 0) {
                 print_position(&engine->position);
 #ifndef NDEBUG
@@ -294,6 +538,72 @@ static void handle_go(struct Engine* engine) {
     start_search(engine);
 }
 
+// Runs the profile command, which runs the go or bench command that follows it while the hardware counters of every
+// search thread are enabled, and prints the counters per thread afterwards. As the profile command waits for the
+// search to finish, a profiled go command must limit the search.
+static void handle_profile(struct Engine* engine) {
+    assert(engine != nullptr);
+
+    // strtok() has already been 'initialized' in the main UCI loop.
+    const char* command = strtok(nullptr, DELIMETERS);
+    if (command == nullptr || (strcmp(command, "go") != 0 && strcmp(command, "bench") != 0)) {
+        puts("info string usage: profile go <arguments> | profile bench [depth] [threads] [hash]");
+        return;
+    }
+
+    struct ThreadPool* thread_pool = &engine->thread_pool;
+    wait_until_finished_searching(thread_pool, true);
+
+    // The thread count may change during the bench, so there is a profile for every possible thread.
+    thread_pool->profiles = calloc(OPTION_THREAD_COUNT_MAX, sizeof(*thread_pool->profiles));
+    if (thread_pool->profiles == nullptr) {
+        puts("info string could not allocate the profiles");
+        return;
+    }
+
+    if (strcmp(command, "go") == 0) {
+        handle_go(engine);
+        wait_until_finished_searching(thread_pool, true);
+    } else {
+        handle_bench(engine);
+    }
+
+    size_t thread_count = 0;
+    for (size_t i = 0; i < OPTION_THREAD_COUNT_MAX; ++i)
+        if (thread_pool->profiles[i].searches > 0)
+            thread_count = i + 1;
+
+    print_perf_profiles(thread_pool->profiles, thread_count);
+
+    free(thread_pool->profiles);
+    thread_pool->profiles = nullptr;
+}
+
+// Runs the trace command, which makes all following searches record their search trees in the trace file at the given
+// path, see trace.h, until the trace command is given again or the engine quits. Tracing stops with trace off.
+static void handle_trace(struct Engine* engine) {
+    assert(engine != nullptr);
+
+    // strtok() has already been 'initialized' in the main UCI loop.
+    const char* path = strtok(nullptr, DELIMETERS);
+    if (path == nullptr) {
+        puts("info string usage: trace <path> | trace off");
+        return;
+    }
+
+    // The searchers flush their traces before they finish searching.
+    wait_until_finished_searching(&engine->thread_pool, true);
+
+#ifdef SEARCH_TRACE
+    if (strcmp(path, "off") == 0)
+        close_search_trace();
+    else if (!open_search_trace(path))
+        printf("info string could not write search trace to %s\n", path);
+#else
+    puts("info string search tracing is not compiled in, build with TRACE=1");
+#endif /* #ifdef SEARCH_TRACE */
+}
+
 void uci_loop(struct Engine* engine) {
     assert(engine != nullptr);
 
@@ -317,7 +627,7 @@ void uci_loop(struct Engine* engine) {
         } else if (strcmp(command, "stop") == 0) {
             stop_search(engine);
         } else if (strcmp(command, "ponderhit") == 0) {
-            // Pondering not implemented yet so do nothing.
+            ponder_hit(engine);
         } else if (strcmp(command, "position") == 0) {
             handle_position(engine);
         } else if (strcmp(command, "isready") == 0) {
@@ -332,13 +642,35 @@ void uci_loop(struct Engine* engine) {
         } else if (strcmp(command, "uci") == 0) {
             uci_id();
             uci_options();
+            printf("info string using %s NNUE kernels\n", nnue_kernels.name);
             puts("uciok");
         } else if (strcmp(command, "quit") == 0) {
             quit_engine(engine);
             break;
         } else if (strcmp(command, "debug") == 0) {
-            // We have no debug mode so consume the on/off token and do nothing.
-            command = strtok(nullptr, DELIMETERS);
+            command                    = strtok(nullptr, DELIMETERS);
+            engine->options.debug_mode = command != nullptr && strcmp(command, "on") == 0;
+#ifndef SEARCH_STATISTICS
+            if (engine->options.debug_mode)
+                puts("info string search statistics are not compiled in, build with STATS=1");
+#endif /* #ifndef SEARCH_STATISTICS */
+        } else if (strcmp(command, "bench") == 0) {
+            // Non-UCI command that searches a fixed set of positions, see bench().
+            handle_bench(engine);
+        } else if (strcmp(command, "profile") == 0) {
+            // Non-UCI command that reports hardware counters of a search or bench, see handle_profile().
+            handle_profile(engine);
+        } else if (strcmp(command, "trace") == 0) {
+            // Non-UCI command that records the search trees of the following searches, see handle_trace().
+            handle_trace(engine);
+        } else if (strcmp(command, "perftsuite") == 0) {
+            // Non-UCI command that checks perft results of the positions in an EPD file, see perft_suite().
+            handle_perft_suite(engine);
+        } else if (strcmp(command, "exportnet") == 0) {
+            // Non-UCI command that writes the current network to a file, which can then be loaded with EvalFile.
+            const char* path = strtok(nullptr, DELIMETERS);
+            if (path != nullptr && !save_network(path))
+                printf("info string could not write network to %s\n", path);
         }
 
         command = strtok(nullptr, DELIMETERS);
@@ -346,8 +678,9 @@ void uci_loop(struct Engine* engine) {
 }
 
 
-void uci_long_info(const size_t depth, const size_t multipv, Value value, const size_t nodes, const uint64_t time,
-                   const Move* principal_variation, const size_t principal_variation_length) {
+void uci_long_info(const size_t depth, const size_t multipv, Value value, const size_t nodes,
+                   const uint64_t tablebase_hits, const uint64_t time, const Move* principal_variation,
+                   const size_t principal_variation_length) {
     assert(principal_variation != nullptr);
     assert(principal_variation_length > 0);
 
@@ -355,8 +688,11 @@ void uci_long_info(const size_t depth, const size_t multipv, Value value, const
     const size_t nps       = (time == 0) ? 0 : 1000000 * nodes / time;
 
     const bool mate = is_mate_value(value);
-    if (mate)
+    if (mate) {
+        // UCI reports mates in moves rather than plies.
         value = mate_score_in_plies(value);
+        value = (value > 0) ? (value + 1) / 2 : value / 2;
+    }
 
     printf("info multipv %zu ", multipv);
     printf("depth %zu ", depth);
@@ -364,7 +700,7 @@ void uci_long_info(const size_t depth, const size_t multipv, Value value, const
     printf(mate ? "score mate %d " : "score cp %d ", value);
     printf("nodes %zu ", nodes);
     printf("nps %zu ", nps);
-    printf("tbhits 0 ");
+    printf("tbhits %" PRIu64 " ", tablebase_hits);
     printf("time %" PRIu64 " ", time_ms);
     printf("pv");
 
@@ -11,13 +11,31 @@
 
 
 
+// The size of a move in UCI format, including the terminator.
+static constexpr size_t MOVE_STRING_SIZE = 6;
+
+
+// Writes `move` in UCI format to `string`.
+void move_to_string(const Move move, char string[static MOVE_STRING_SIZE]);
 // Print `move` in UCI format to `stdout`.
 void print_move(const Move move);
 
-// Prints `best_move` in UCI format to `stdout`.
-void uci_best_move(const Move best_move);
-void uci_long_info(const size_t depth, const size_t multipv, Value value, const size_t nodes, const uint64_t time,
-                   const Move* principal_variation, const size_t principal_variation_length);
+// Prints `best_move` in UCI format to `stdout`, followed by `ponder_move` unless it is NULL_MOVE. A `best_move` of
+// NULL_MOVE means that there are no legal moves and is printed as 0000.
+void uci_best_move(const Move best_move, const Move ponder_move);
+// Prints the hit rate of the eval caches of all threads, given the total number of `probes` and `hits`.
+void uci_eval_cache_info(const uint64_t probes, const uint64_t hits);
+// Prints that the mate search proved there is no mate in at most `moves` moves, after searching `nodes` nodes in `time`
+// microseconds. A `moves` of 0 means the search was stopped before any result.
+void uci_no_mate_info(const size_t moves, const size_t nodes, const uint64_t time);
+// Prints the search statistics summed over all threads, given the total number of `nodes` searched. A
+// `branching_factor` of 0 means the effective branching factor is not known yet.
+void uci_search_statistics_info(const uint64_t nodes, const uint64_t quiescence_nodes, const uint64_t cutoffs,
+                                const uint64_t first_move_cutoffs, const uint64_t cutoff_index_sum,
+                                const uint64_t material_draw_cutoffs, const double branching_factor);
+void uci_long_info(const size_t depth, const size_t multipv, Value value, const size_t nodes,
+                   const uint64_t tablebase_hits, const uint64_t time, const Move* principal_variation,
+                   const size_t principal_variation_length);
 
 // Run the main UCI loop.
 void uci_loop(struct Engine* engine);
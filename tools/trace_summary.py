@@ -0,0 +1,111 @@
+import argparse
+import numpy as np
+
+
+TRACE_MAGIC = b"WMTRACE\0"
+TRACE_VERSION = 1
+TRACE_NO_CUTOFF = 255
+
+# The layout of struct TraceEvent in src/trace.h.
+EVENT_DTYPE = np.dtype([
+    ("move", "<u2"),
+    ("alpha", "<i2"),
+    ("beta", "<i2"),
+    ("value", "<i2"),
+    ("ply", "u1"),
+    ("depth", "u1"),
+    ("cutoff_index", "u1"),
+    ("move_index", "u1"),
+])
+CHUNK_DTYPE = np.dtype([("search", "<u4"), ("thread_index", "<u4"), ("event_count", "<u4")])
+
+
+def read_trace(path):
+    with open(path, "rb") as f:
+        data = f.read()
+
+    header = np.frombuffer(data, dtype="<u4", count=2, offset=len(TRACE_MAGIC))
+    if data[:len(TRACE_MAGIC)] != TRACE_MAGIC or header[0] != TRACE_VERSION or header[1] != EVENT_DTYPE.itemsize:
+        raise ValueError(f"{path} is not a version {TRACE_VERSION} search trace")
+
+    events, searches, threads = [], [], []
+    offset = len(TRACE_MAGIC) + header.nbytes
+    while offset < len(data):
+        chunk = np.frombuffer(data, dtype=CHUNK_DTYPE, count=1, offset=offset)[0]
+        offset += CHUNK_DTYPE.itemsize
+
+        event_count = int(chunk["event_count"])
+        events.append(np.frombuffer(data, dtype=EVENT_DTYPE, count=event_count, offset=offset))
+        searches.append(np.full(event_count, chunk["search"], dtype=np.uint32))
+        threads.append(np.full(event_count, chunk["thread_index"], dtype=np.uint32))
+        offset += event_count * EVENT_DTYPE.itemsize
+
+    if not events:
+        return np.zeros(0, dtype=EVENT_DTYPE), np.zeros(0, dtype=np.uint32), np.zeros(0, dtype=np.uint32)
+
+    return np.concatenate(events), np.concatenate(searches), np.concatenate(threads)
+
+def percentage(part, total):
+    return 100.0 * part / total if total > 0 else 0.0
+
+def print_ply_summary(events):
+    quiescence = events["depth"] == 0
+    fail_high = events["value"] >= events["beta"]
+    fail_low = events["value"] <= events["alpha"]
+    cutoff = events["cutoff_index"] != TRACE_NO_CUTOFF
+
+    print(f"{'ply':>4} {'nodes':>12} {'qsearch':>8} {'fail high':>10} {'fail low':>9} {'cutoffs':>10} "
+          f"{'first':>7} {'avg index':>10}")
+    for ply in np.unique(events["ply"]):
+        at_ply = events["ply"] == ply
+        nodes = int(np.count_nonzero(at_ply))
+        cutoffs = int(np.count_nonzero(at_ply & cutoff))
+        indices = events["cutoff_index"][at_ply & cutoff].astype(np.float64)
+
+        print(f"{ply:>4} {nodes:>12} {percentage(np.count_nonzero(at_ply & quiescence), nodes):>7.1f}% "
+              f"{percentage(np.count_nonzero(at_ply & fail_high), nodes):>9.1f}% "
+              f"{percentage(np.count_nonzero(at_ply & fail_low), nodes):>8.1f}% {cutoffs:>10} "
+              f"{percentage(np.count_nonzero(indices == 0), cutoffs):>6.1f}% "
+              f"{indices.mean() if cutoffs > 0 else 0.0:>10.2f}")
+
+def print_cutoff_histogram(events, max_index):
+    for name, selection in (("search", events["depth"] > 0), ("quiescence search", events["depth"] == 0)):
+        indices = events["cutoff_index"][selection]
+        indices = indices[indices != TRACE_NO_CUTOFF]
+        if len(indices) == 0:
+            continue
+
+        counts = np.bincount(np.minimum(indices, max_index), minlength=max_index + 1)
+        print(f"\ncutoff move index in the {name} ({len(indices)} cutoffs)")
+        for index, count in enumerate(counts):
+            label = f"{index}" if index < max_index else f"{max_index}+"
+            print(f"{label:>4} {count:>12} {percentage(count, len(indices)):>6.1f}%")
+
+def main():
+    parser = argparse.ArgumentParser(description="Summarizes a search trace written by the trace command of windmolen.")
+    parser.add_argument("path", help="the search trace file")
+    parser.add_argument("--search", type=int, help="only summarize this search, counting from 1")
+    parser.add_argument("--thread", type=int, help="only summarize this search thread, counting from 0")
+    parser.add_argument("--max-index", type=int, default=10, help="the last bucket of the cutoff index histogram")
+    arguments = parser.parse_args()
+
+    events, searches, threads = read_trace(arguments.path)
+    selection = np.ones(len(events), dtype=bool)
+    if arguments.search is not None:
+        selection &= searches == arguments.search
+    if arguments.thread is not None:
+        selection &= threads == arguments.thread
+    events = events[selection]
+
+    quiescence_nodes = np.count_nonzero(events["depth"] == 0)
+    print(f"{len(np.unique(searches[selection]))} searches, {len(np.unique(threads[selection]))} threads, "
+          f"{len(events)} nodes, {percentage(quiescence_nodes, len(events)):.1f}% in the quiescence search\n")
+    if len(events) == 0:
+        return
+
+    print_ply_summary(events)
+    print_cutoff_histogram(events, arguments.max_index)
+
+
+if __name__ == "__main__":
+    main()